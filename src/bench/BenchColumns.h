@@ -0,0 +1,66 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <glm/vec2.hpp>
+
+#include "world/ChunkColumn.h"
+#include "world/ChunkColumnPool.h"
+#include "world/TerrainGenerator.h"
+
+namespace mc::bench {
+    using Clock = std::chrono::steady_clock;
+
+    inline double elapsedUs(Clock::time_point start) {
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+
+    // a square of 2 * radius + 1 columns a side around the origin, generated, decorated and linked to each other;
+    // the same seed and mode give the same blocks whatever the build, so benches built differently compare alike
+    class GeneratedColumns {
+    public:
+        GeneratedColumns(world::TerrainGenerationMode mode, std::uint32_t seed, int radius)
+            : radius_{radius}, side_{2 * radius + 1} {
+            world::TerrainGenerator generator(mode, seed);
+            for (int z = -radius; z <= radius; ++z)
+                for (int x = -radius; x <= radius; ++x) {
+                    auto column = pool_.acquireColumn({x, z});
+                    generator.generate(*column, pool_, world::ALL_CHUNKS);
+                    generator.decorate(*column, pool_, world::ALL_CHUNKS);
+                    columns_.push_back(std::move(column));
+                }
+
+            for (int z = -radius; z <= radius; ++z)
+                for (int x = -radius; x <= radius; ++x) {
+                    if (x < radius) at({x, z}).linkNeighbor(world::Direction::PositiveX, at({x + 1, z}));
+                    if (z < radius) at({x, z}).linkNeighbor(world::Direction::PositiveZ, at({x, z + 1}));
+                }
+        }
+
+        ~GeneratedColumns() {
+            for (auto &column: columns_) pool_.release(std::move(column));
+        }
+
+        GeneratedColumns(const GeneratedColumns &) = delete;
+        GeneratedColumns &operator=(const GeneratedColumns &) = delete;
+
+        world::ChunkColumn &at(const glm::ivec2 &coord) {
+            return *columns_[(coord.y + radius_) * side_ + coord.x + radius_];
+        }
+
+        // every column, the border ones lacking the neighbours outside the square
+        const std::vector<std::unique_ptr<world::ChunkColumn> > &columns() const { return columns_; }
+
+        // the columns with all four neighbours, so their meshes see no missing border
+        template<typename Fn>
+        void forEachInner(Fn fn) {
+            for (int z = -radius_ + 1; z < radius_; ++z)
+                for (int x = -radius_ + 1; x < radius_; ++x) fn(at({x, z}));
+        }
+
+    private:
+        int radius_, side_;
+        world::ChunkColumnPool pool_;
+        std::vector<std::unique_ptr<world::ChunkColumn> > columns_;
+    };
+}
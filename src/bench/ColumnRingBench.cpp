@@ -0,0 +1,79 @@
+#include <charconv>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <glm/vec3.hpp>
+#include <spdlog/spdlog.h>
+
+#include "BenchColumns.h"
+#include "world/ColumnRing.h"
+#include "world/World.h"
+
+using namespace mc;
+using namespace mc::world;
+
+namespace {
+    // World::chunkLookup over either index, down to the chunk pointer
+    template<typename FindFn>
+    std::uint64_t lookUp(const std::vector<glm::ivec3> &worldCoords, FindFn find) {
+        std::uint64_t found = 0;
+        for (const glm::ivec3 &world_coord: worldCoords)
+            if (const ChunkColumn *column = find(World::worldToColumn(world_coord))) {
+                int index = world_coord.y >> CHUNK_BITS;
+                if (index >= 0 && index < CHUNKS_PER_COLUMN)
+                    found += column->chunks()[index] != nullptr ? 2 : 1;
+            }
+        return found;
+    }
+
+    template<typename FindFn>
+    double lookupNs(const std::vector<glm::ivec3> &worldCoords, int repeats, FindFn find, std::uint64_t &found) {
+        auto start = bench::Clock::now();
+        for (int r = 0; r < repeats; ++r) found += lookUp(worldCoords, find);
+        return bench::elapsedUs(start) * 1000.0 / (static_cast<double>(worldCoords.size()) * repeats);
+    }
+}
+
+// chunkLookup-style lookups of random blocks in the loaded disk, through the ColumnRing World keeps its columns in
+// and through the unordered_map with ColumnHash it replaced. usage: column_ring_bench [repeats]
+int main(int argc, char **argv) {
+    int repeats = 300;
+    if (argc > 1) std::from_chars(argv[1], argv[1] + std::string_view(argv[1]).size(), repeats);
+
+    ColumnRing<ChunkColumn, LOAD_RADIUS> ring;
+    std::unordered_map<glm::ivec2, ChunkColumn *, ColumnHash> map;
+    for (int z = -LOAD_RADIUS; z <= LOAD_RADIUS; ++z)
+        for (int x = -LOAD_RADIUS; x <= LOAD_RADIUS; ++x) {
+            if (x * x + z * z > LOAD_RADIUS * LOAD_RADIUS) continue;
+            glm::ivec2 coord{x, z};
+            auto column = std::make_unique<ChunkColumn>(coord);
+            map.emplace(coord, column.get());
+            ring.emplace(coord, std::move(column));
+        }
+
+    // the whole square around the disk, so some lookups miss as they would at its edge
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> horizontal(-LOAD_RADIUS * CHUNK_XYZ, (LOAD_RADIUS + 1) * CHUNK_XYZ - 1);
+    std::uniform_int_distribution<int> vertical(MIN_WORLD_Y, MAX_WORLD_Y);
+    std::vector<glm::ivec3> world_coords(std::size_t{1} << 16);
+    for (glm::ivec3 &world_coord: world_coords)
+        world_coord = {horizontal(random), vertical(random), horizontal(random)};
+
+    std::uint64_t ring_found = 0, map_found = 0;
+    double ring_ns = lookupNs(world_coords, repeats, [&](const glm::ivec2 &coord) { return ring.find(coord); },
+                              ring_found);
+    double map_ns = lookupNs(world_coords, repeats, [&](const glm::ivec2 &coord) -> ChunkColumn * {
+        auto it = map.find(coord);
+        return it != map.end() ? it->second : nullptr;
+    }, map_found);
+
+    if (ring_found != map_found) {
+        spdlog::error("The ring and the map disagree: {} and {} found", ring_found, map_found);
+        return 1;
+    }
+    spdlog::info("{} columns, {} lookups: ColumnRing {:.2f} ns, unordered_map {:.2f} ns per lookup ({:.1f}x)",
+                 ring.size(), world_coords.size() * repeats, ring_ns, map_ns, map_ns / ring_ns);
+}
@@ -0,0 +1,158 @@
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+#include "BenchColumns.h"
+#include "renderer/Mesher.h"
+#include "renderer/PaddedOccupancy.h"
+
+using namespace mc;
+using namespace mc::world;
+
+namespace {
+    constexpr int REPEATS = 5;
+
+    constexpr const char *STORAGE_NAME = std::is_same_v<ChunkBlockStorage, FlatBlockStorage> ? "flat" : "palette";
+
+    struct BenchChunk {
+        const Chunk *chunk;
+        AdjacentChunks neighbors;
+    };
+
+    // every voxel of every chunk through blockAt, in storage order
+    double blockAtNs(const std::vector<BenchChunk> &chunks) {
+        std::uint64_t sum = 0;
+        auto start = bench::Clock::now();
+        for (int r = 0; r < REPEATS; ++r)
+            for (const BenchChunk &bench_chunk: chunks)
+                for (int y = 0; y < CHUNK_XYZ; ++y)
+                    for (int z = 0; z < CHUNK_XYZ; ++z)
+                        for (int x = 0; x < CHUNK_XYZ; ++x)
+                            sum += static_cast<std::uint64_t>(bench_chunk.chunk->blockAt({x, y, z}).id);
+        double us = bench::elapsedUs(start);
+        if (sum == 0) spdlog::warn("Only air was read");
+        return us * 1000.0 / (static_cast<double>(chunks.size()) * CHUNK_VOLUME * REPEATS);
+    }
+
+    // the padding as the mesher built it before padOccupancy: the facing plane of each neighbour copied out of its
+    // block storage (a strided gather for +-X), then set into the rows a block at a time
+    PaddedOccupancy padFromSidePlanes(const Chunk &chunk, const AdjacentChunks &neighbors) {
+        using SidePlane = std::array<Block, CHUNK_SLICE_VOLUME>;
+        std::array<SidePlane, DIRECTIONS_COUNT> planes{};
+        for (Direction direction: DIRECTIONS) {
+            int d = directionToIndex(direction);
+            const Chunk *neighbor = neighbors[d];
+            if (!neighbor) continue;
+            // the neighbour's side facing the chunk, indexed (a, b) as the padding below reads it
+            for (int a = 0; a < CHUNK_XYZ; ++a)
+                for (int b = 0; b < CHUNK_XYZ; ++b) {
+                    glm::ivec3 local_coord;
+                    switch (direction) {
+                        case Direction::PositiveX: local_coord = {0, a, b}; break;
+                        case Direction::NegativeX: local_coord = {LAST, a, b}; break;
+                        case Direction::PositiveY: local_coord = {b, 0, a}; break;
+                        case Direction::NegativeY: local_coord = {b, LAST, a}; break;
+                        case Direction::PositiveZ: local_coord = {b, a, 0}; break;
+                        case Direction::NegativeZ: local_coord = {b, a, LAST}; break;
+                    }
+                    planes[d][a * CHUNK_XYZ + b] = neighbor->blockAt(local_coord);
+                }
+        }
+
+        PaddedOccupancy padded;
+        for (int y = 0; y < CHUNK_XYZ; ++y)
+            for (int z = 0; z < CHUNK_XYZ; ++z) {
+                int row = PaddedOccupancy::row(y, z);
+                padded.opaque[row] = std::uint64_t{chunk.occupancy().opaqueRow(y, z)} << 1;
+                padded.occluding[row] = std::uint64_t{chunk.occupancy().occludingRow(y, z)} << 1;
+            }
+        auto set = [&](int x, int y, int z, Block block) {
+            padded.opaque[PaddedOccupancy::row(y, z)] |= std::uint64_t{block.opaque()} << (x + 1);
+            padded.occluding[PaddedOccupancy::row(y, z)] |= std::uint64_t{block.occluding()} << (x + 1);
+        };
+        auto side = [&](Direction direction, int a, int b) {
+            return planes[directionToIndex(direction)][a * CHUNK_XYZ + b];
+        };
+        for (int a = 0; a < CHUNK_XYZ; ++a)
+            for (int b = 0; b < CHUNK_XYZ; ++b) {
+                set(-1, a, b, side(Direction::NegativeX, a, b));
+                set(CHUNK_XYZ, a, b, side(Direction::PositiveX, a, b));
+                set(b, -1, a, side(Direction::NegativeY, a, b));
+                set(b, CHUNK_XYZ, a, side(Direction::PositiveY, a, b));
+                set(b, a, -1, side(Direction::NegativeZ, a, b));
+                set(b, a, CHUNK_XYZ, side(Direction::PositiveZ, a, b));
+            }
+        return padded;
+    }
+
+    template<typename PadFn>
+    double padUs(const std::vector<BenchChunk> &chunks, PadFn pad) {
+        std::uint64_t sum = 0;
+        auto start = bench::Clock::now();
+        for (int r = 0; r < REPEATS; ++r)
+            for (const BenchChunk &bench_chunk: chunks) {
+                PaddedOccupancy padded = pad(*bench_chunk.chunk, bench_chunk.neighbors);
+                sum += std::popcount(padded.opaque[PaddedOccupancy::row(LAST, LAST)]);
+            }
+        double us = bench::elapsedUs(start);
+        if (sum == 0) spdlog::warn("Only clear rows were padded");
+        return us / (static_cast<double>(chunks.size()) * REPEATS);
+    }
+}
+
+// meshes generated chunks read through this build's block storage; mesher_bench_palette and mesher_bench_flat
+// generate the same chunks, so their numbers compare. the padding of each chunk's occupancy with its neighbours'
+// border voxels is timed on its own, against the side plane copies it replaced. usage: mesher_bench_<storage> [radius]
+int main(int argc, char **argv) {
+    int radius = 6;
+    if (argc > 1) std::from_chars(argv[1], argv[1] + std::string_view(argv[1]).size(), radius);
+
+    bench::GeneratedColumns columns(TerrainGenerationMode::PerlinNoise, 7, radius);
+    std::vector<BenchChunk> chunks;
+    std::size_t resident_bytes = 0;
+    columns.forEachInner([&](const ChunkColumn &column) {
+        resident_bytes += column.memoryUsage();
+        for (int i = 0; i < CHUNKS_PER_COLUMN; ++i)
+            if (const Chunk *chunk = column.chunks()[i].get(); chunk && !chunk->isUniform())
+                chunks.push_back({chunk, column.adjacentChunks(i)});
+    });
+    if (chunks.empty()) {
+        spdlog::error("No chunks to mesh within radius {}", radius);
+        return 1;
+    }
+
+    spdlog::info("{} storage: {} non-uniform chunks, {:.1f} MiB resident, blockAt {:.2f} ns", STORAGE_NAME,
+                 chunks.size(), static_cast<double>(resident_bytes) / (1024.0 * 1024.0), blockAtNs(chunks));
+
+    std::size_t differing = 0;
+    for (const BenchChunk &bench_chunk: chunks) {
+        PaddedOccupancy rows = padOccupancy(*bench_chunk.chunk, bench_chunk.neighbors);
+        PaddedOccupancy planes = padFromSidePlanes(*bench_chunk.chunk, bench_chunk.neighbors);
+        if (rows.opaque != planes.opaque || rows.occluding != planes.occluding) ++differing;
+    }
+    double rows_us = padUs(chunks, padOccupancy);
+    double planes_us = padUs(chunks, padFromSidePlanes);
+    spdlog::info("{} storage, padding: {:.2f} us per chunk from occupancy rows, {:.2f} us from side planes "
+                 "({:.1f}x){}", STORAGE_NAME, rows_us, planes_us, planes_us / rows_us,
+                 differing ? fmt::format(", {} chunks padded differently", differing) : "");
+
+    for (int m = 0; m < MESHING_MODES_COUNT; ++m) {
+        auto mode = static_cast<MeshingMode>(m);
+        std::size_t vertices = 0;
+        auto start = bench::Clock::now();
+        for (int r = 0; r < REPEATS; ++r)
+            for (const BenchChunk &bench_chunk: chunks) {
+                MeshLayers layers = Mesher::buildChunkMeshLayers(*bench_chunk.chunk, bench_chunk.neighbors, mode);
+                vertices += layers.vertices[0].size() + layers.vertices[1].size();
+            }
+        double us = bench::elapsedUs(start) / static_cast<double>(chunks.size() * REPEATS);
+        spdlog::info("{} storage, {} meshing: {:.1f} us per chunk, {:.0f} chunks/s, {} vertices per chunk",
+                     STORAGE_NAME, meshingModeName(mode), us, 1e6 / us, vertices / (chunks.size() * REPEATS));
+    }
+    return differing ? 1 : 0;
+}
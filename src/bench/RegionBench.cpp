@@ -0,0 +1,99 @@
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+#include "BenchColumns.h"
+#include "world/ChunkColumn.h"
+#include "world/ChunkColumnPool.h"
+#include "world/ColumnCodec.h"
+#include "world/GenerationCheck.h"
+#include "world/RegionStore.h"
+#include "world/TerrainGenerator.h"
+
+using namespace mc;
+using namespace mc::world;
+
+namespace {
+    constexpr std::uint32_t SEED = 7;
+
+    double perSecond(std::size_t count, double us) { return us > 0.0 ? static_cast<double>(count) * 1e6 / us : 0.0; }
+}
+
+// per terrain mode: generates and decorates a square of columns, as a load without saves does, then encodes and
+// writes them to region files, and reads and decodes them back from a reopened store, as a load of saved columns
+// does. reads come from the page cache. usage: region_bench [radius]
+int main(int argc, char **argv) {
+    int radius = 8;
+    if (argc > 1) std::from_chars(argv[1], argv[1] + std::string_view(argv[1]).size(), radius);
+
+    std::vector<glm::ivec2> coords;
+    for (int z = -radius; z <= radius; ++z)
+        for (int x = -radius; x <= radius; ++x) coords.emplace_back(x, z);
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "mc_region_bench";
+    bool matched = true;
+
+    for (int m = 0; m < TERRAIN_MODES_COUNT; ++m) {
+        auto mode = static_cast<TerrainGenerationMode>(m);
+        TerrainGenerator generator(mode, SEED);
+        ChunkColumnPool pool;
+        std::filesystem::remove_all(directory);
+
+        std::vector<std::unique_ptr<ChunkColumn> > columns;
+        auto start = bench::Clock::now();
+        for (const glm::ivec2 &coord: coords) {
+            auto column = pool.acquireColumn(coord);
+            generator.generate(*column, pool, ALL_CHUNKS);
+            generator.decorate(*column, pool, ALL_CHUNKS);
+            columns.push_back(std::move(column));
+        }
+        double generate_us = bench::elapsedUs(start);
+
+        std::size_t bytes = 0;
+        {
+            RegionStore store(directory);
+            start = bench::Clock::now();
+            for (const auto &column: columns) {
+                std::vector<std::uint8_t> payload = ColumnCodec::encode(*column);
+                bytes += payload.size();
+                store.write(column->coord(), payload);
+            }
+        }
+        double write_us = bench::elapsedUs(start);
+
+        std::vector<std::unique_ptr<ChunkColumn> > loaded;
+        {
+            RegionStore store(directory);
+            start = bench::Clock::now();
+            for (const glm::ivec2 &coord: coords) {
+                auto column = pool.acquireColumn(coord);
+                if (auto payload = store.read(coord)) ColumnCodec::decode(*payload, *column, pool);
+                loaded.push_back(std::move(column));
+            }
+        }
+        double read_us = bench::elapsedUs(start);
+
+        std::size_t differing = 0;
+        for (std::size_t i = 0; i < columns.size(); ++i)
+            if (GenerationCheck::hashColumn(*columns[i]) != GenerationCheck::hashColumn(*loaded[i])) ++differing;
+        matched = matched && differing == 0;
+
+        spdlog::info("{:>7}: {} columns, {:.1f} KiB each; generate {:.0f}/s, write {:.0f}/s, read {:.0f}/s "
+                     "({:.1f}x faster than generating){}", terrainModeName(mode), coords.size(),
+                     static_cast<double>(bytes) / (1024.0 * static_cast<double>(coords.size())),
+                     perSecond(coords.size(), generate_us), perSecond(coords.size(), write_us),
+                     perSecond(coords.size(), read_us), generate_us / read_us,
+                     differing ? fmt::format(", {} columns read back differ", differing) : "");
+
+        for (auto &column: columns) pool.release(std::move(column));
+        for (auto &column: loaded) pool.release(std::move(column));
+    }
+
+    std::filesystem::remove_all(directory);
+    return matched ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+#include <spdlog/spdlog.h>
+
+#include "BenchColumns.h"
+#include "world/ChunkColumn.h"
+#include "world/ChunkColumnPool.h"
+#include "world/PerlinNoise.h"
+#include "world/TerrainGenerator.h"
+
+using namespace mc;
+using namespace mc::world;
+
+namespace {
+    constexpr std::uint32_t SEED = 7;
+    // the perlin heightmap's scale, one noiseRow per heightmap row
+    constexpr float PERLIN_SCALE = 32.f;
+
+    // terrain of every chunk of side * side columns from the origin, each released to the pool again before the
+    // next one is generated, as streaming recycles them
+    double generateUs(TerrainGenerationMode mode, int side) {
+        TerrainGenerator generator(mode, SEED);
+        ChunkColumnPool pool;
+        auto start = bench::Clock::now();
+        for (int z = 0; z < side; ++z)
+            for (int x = 0; x < side; ++x) {
+                auto column = pool.acquireColumn({x, z});
+                generator.generate(*column, pool, ALL_CHUNKS);
+                pool.release(std::move(column));
+            }
+        return bench::elapsedUs(start);
+    }
+
+    // the noise sampling alone of the same perlin heightmaps
+    double perlinNoiseUs(int side) {
+        PerlinNoise noise(SEED);
+        std::array<float, CHUNK_XYZ> row;
+        float sum = 0.f;
+        auto start = bench::Clock::now();
+        for (int column_z = 0; column_z < side; ++column_z)
+            for (int column_x = 0; column_x < side; ++column_x)
+                for (int z = 0; z < CHUNK_XYZ; ++z) {
+                    noise.noiseRow(row.data(), static_cast<float>(column_x * CHUNK_XYZ) / PERLIN_SCALE,
+                                   static_cast<float>(column_z * CHUNK_XYZ + z) / PERLIN_SCALE, 1.f / PERLIN_SCALE,
+                                   CHUNK_XYZ);
+                    sum += row[z];
+                }
+        double us = bench::elapsedUs(start);
+        if (sum == 0.f) spdlog::warn("Noise summed to zero");
+        return us;
+    }
+}
+
+// base terrain generation, without decoration, in columns/s per terrain mode on one thread, and how much of a
+// perlin column is its noise. usage: terrain_bench [side, columns per square side]
+int main(int argc, char **argv) {
+    int side = 32;
+    if (argc > 1) std::from_chars(argv[1], argv[1] + std::string_view(argv[1]).size(), side);
+    int columns = side * side;
+
+    double perlin_us = 0.0;
+    for (int m = 0; m < TERRAIN_MODES_COUNT; ++m) {
+        auto mode = static_cast<TerrainGenerationMode>(m);
+        double us = generateUs(mode, side);
+        if (mode == TerrainGenerationMode::PerlinNoise) perlin_us = us;
+        spdlog::info("{:>7}: {} columns, {:.0f} columns/s, {:.0f} us per column", terrainModeName(mode), columns,
+                     columns * 1e6 / us, us / columns);
+    }
+
+    double noise_us = perlinNoiseUs(side);
+    spdlog::info(" perlin noise: {:.1f} us per column, {:.1f}% of generating it", noise_us / columns,
+                 100.0 * noise_us / perlin_us);
+}
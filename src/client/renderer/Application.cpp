@@ -33,6 +33,7 @@ void Application::run() const {
 
         input_system_->update(dt);
         renderer_->streamMeshColumns(player_->camera());
+        renderer_->autosave();
         renderer_->renderFrame(player_->camera());
 
         glfwSwapBuffers(window_);
@@ -6,9 +6,9 @@
 using namespace mc::gfx;
 
 ChunkMesh::ChunkMesh(const world::Chunk &chunk,
-                     const std::array<world::Chunk *, world::DIRECTIONS_COUNT> &neighbors,
-                     TextureAtlas &textureAtlas) {
-    layers = world::Mesher::buildChunkMeshLayers(chunk, neighbors, textureAtlas);
+                     const world::AdjacentChunks &neighbors,
+                     world::MeshingMode mode) {
+    layers = world::Mesher::buildChunkMeshLayers(chunk, neighbors, mode);
 
     for (int layer = 0; layer < NUM_RENDER_LAYERS; ++layer) {
         vao_[layer] = 0;
@@ -40,11 +40,11 @@ void ChunkMesh::buildLayer(int layer) {
 
     glEnableVertexArrayAttrib(vao, 0); // position
     glEnableVertexArrayAttrib(vao, 1); // normal
-    glEnableVertexArrayAttrib(vao, 2); // uv
+    glEnableVertexArrayAttrib(vao, 2); // tile and uv
 
     glVertexArrayAttribIFormat(vao, 0, 3,GL_UNSIGNED_BYTE, offsetof(world::Vertex, position));
     glVertexArrayAttribIFormat(vao, 1, 1,GL_UNSIGNED_BYTE, offsetof(world::Vertex, packed_normal));
-    glVertexArrayAttribFormat(vao, 2, 2,GL_UNSIGNED_SHORT, GL_TRUE, offsetof(world::Vertex, uv));
+    glVertexArrayAttribIFormat(vao, 2, 1,GL_UNSIGNED_INT, offsetof(world::Vertex, texture));
 
     glVertexArrayAttribBinding(vao, 0, 0);
     glVertexArrayAttribBinding(vao, 1, 0);
@@ -68,9 +68,9 @@ void ChunkMesh::buildLayer(int layer) {
 
 
 void ChunkMesh::rebuild(const world::Chunk &chunk,
-                        const std::array<world::Chunk *, world::DIRECTIONS_COUNT> &neighbors,
-                        TextureAtlas &textureAtlas) {
-    layers = world::Mesher::buildChunkMeshLayers(chunk, neighbors, textureAtlas);
+                        const world::AdjacentChunks &neighbors,
+                        world::MeshingMode mode) {
+    layers = world::Mesher::buildChunkMeshLayers(chunk, neighbors, mode);
 
     for (int layer = 0; layer < NUM_RENDER_LAYERS; ++layer)
         index_count_[layer] = static_cast<std::uint32_t>(layers.indices[layer].size());
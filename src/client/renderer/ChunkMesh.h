@@ -7,16 +7,16 @@ namespace mc::gfx {
     class ChunkMesh {
     public:
         ChunkMesh(const world::Chunk &chunk,
-                  const std::array<world::Chunk *, world::DIRECTIONS_COUNT> &neighbors,
-                  TextureAtlas &textureAtlas);
+                  const world::AdjacentChunks &neighbors,
+                  world::MeshingMode mode);
 
         ~ChunkMesh();
 
         void buildLayers();
 
         void rebuild(const world::Chunk &chunk,
-                     const std::array<world::Chunk *, world::DIRECTIONS_COUNT> &neighbors,
-                     TextureAtlas &textureAtlas);
+                     const world::AdjacentChunks &neighbors,
+                     world::MeshingMode mode);
 
         void drawOccluding() const;
 
@@ -24,6 +24,15 @@ namespace mc::gfx {
 
         bool isEmpty() const { return index_count_[0] == 0 && index_count_[1] == 0; }
 
+        // vertex and index bytes buildLayers will upload
+        std::size_t pendingUploadBytes() const {
+            std::size_t bytes = 0;
+            for (int layer = 0; layer < NUM_RENDER_LAYERS; ++layer)
+                bytes += layers.vertices[layer].size() * sizeof(world::Vertex) +
+                        layers.indices[layer].size() * sizeof(std::uint32_t);
+            return bytes;
+        }
+
         const glm::ivec3 &origin() const { return aabb_min_; }
         const glm::ivec3 &aabb_min() const { return aabb_min_; }
         const glm::ivec3 &aabb_max() const { return aabb_max_; }
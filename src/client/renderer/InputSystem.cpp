@@ -27,7 +27,7 @@ void InputSystem::update(float dt) const {
     for (int i = 0; i < 9; ++i)
         if (key(GLFW_KEY_1 + i)) player_.selectSlot(i);
 
-    static bool r_prev = false, p_prev = false;
+    static bool r_prev = false, p_prev = false, m_prev = false;
     static int seed = 1;
 
     bool r_now = key(GLFW_KEY_R);
@@ -38,6 +38,10 @@ void InputSystem::update(float dt) const {
     if (p_now && !p_prev) renderer_.toggleTerrainGenerationMode();
     p_prev = p_now;
 
+    bool m_now = key(GLFW_KEY_M);
+    if (m_now && !m_prev) renderer_.toggleMeshingMode();
+    m_prev = m_now;
+
     static bool l_prev_mb = false, r_prev_mb = false;
     bool l_now_mb = mouse(GLFW_MOUSE_BUTTON_LEFT);
     bool r_now_mb = mouse(GLFW_MOUSE_BUTTON_RIGHT);
@@ -2,29 +2,89 @@
 
 using namespace mc::gfx;
 
-void MeshColumn::generate(const world::ChunkColumn &chunkColumn, TextureAtlas &atlas) {
-    for (auto &mesh_ptr: meshes_) mesh_ptr.reset();
+bool MeshColumn::build(std::span<const world::ChunkSnapshot> snapshots, world::MeshingMode mode,
+                       const core::CancelToken *cancel) {
+    for (const world::ChunkSnapshot &snapshot: snapshots) {
+        int index = snapshot.index();
+        if (!((render_mask_ >> index) & 1u)) continue;
+        if (cancel && cancel->cancelled()) return false;
 
+        auto mesh = std::make_unique<ChunkMesh>(snapshot.chunk(), snapshot.neighbors(), mode);
+        meshes_[index] = mesh->isEmpty() ? nullptr : std::move(mesh);
+        versions_[index] = snapshot.versions();
+    }
+    return true;
+}
+
+mc::world::ChunkMask MeshColumn::setRenderMask(world::ChunkMask renderMask) {
+    world::ChunkMask leaving = render_mask_ & ~renderMask;
+    for (int i = 0; i < world::CHUNKS_PER_COLUMN; ++i)
+        if ((leaving >> i) & 1u) {
+            meshes_[i].reset();
+            versions_[i] = {};
+        }
+
+    world::ChunkMask entering = renderMask & ~render_mask_;
+    render_mask_ = renderMask;
+    return entering;
+}
+
+mc::world::ChunkMask MeshColumn::staleMeshes(const world::ChunkColumn &chunkColumn) const {
+    world::ChunkMask stale = 0;
     for (int i = 0; i < world::CHUNKS_PER_COLUMN; ++i) {
-        auto &chunk_ptr = chunkColumn.chunks()[i];
-        if (!chunk_ptr) continue;
+        if (!((render_mask_ >> i) & 1u)) continue;
+        world::ChunkVersions current = world::ChunkSnapshot::currentVersions(chunkColumn, i);
+        // an absent chunk has no faces, whatever its neighbours did
+        if (current.chunk != versions_[i].chunk || (current.chunk && current != versions_[i]))
+            stale |= world::ChunkMask{1} << i;
+    }
+    return stale;
+}
 
-        auto neighbours = chunkColumn.adjacentChunks(i);
-        auto mesh = std::make_unique<ChunkMesh>(*chunk_ptr, neighbours, atlas);
+void MeshColumn::buildLayers(world::ChunkMask mask) {
+    for (int i = 0; i < world::CHUNKS_PER_COLUMN; ++i)
+        if (((mask >> i) & 1u) && meshes_[i]) meshes_[i]->buildLayers();
+}
 
-        if (!mesh->isEmpty()) meshes_[i] = std::move(mesh);
+mc::world::ChunkMask MeshColumn::adoptMeshes(MeshColumn &other, world::ChunkMask mask,
+                                             const world::ChunkColumn &chunkColumn) {
+    world::ChunkMask adopted = 0;
+    mask &= render_mask_;
+    for (int i = 0; i < world::CHUNKS_PER_COLUMN; ++i) {
+        if (!((mask >> i) & 1u)) continue;
+        // an edit remeshed it on the render thread after other's snapshot was taken
+        if (versions_[i] == world::ChunkSnapshot::currentVersions(chunkColumn, i)) continue;
+
+        meshes_[i] = std::move(other.meshes_[i]);
+        versions_[i] = other.versions_[i];
+        adopted |= world::ChunkMask{1} << i;
     }
+    return adopted;
+}
+
+std::size_t MeshColumn::pendingUploadBytes(world::ChunkMask mask) const {
+    std::size_t bytes = 0;
+    for (int i = 0; i < world::CHUNKS_PER_COLUMN; ++i)
+        if (((mask >> i) & 1u) && meshes_[i]) bytes += meshes_[i]->pendingUploadBytes();
+    return bytes;
 }
 
-void MeshColumn::rebuildMesh(const world::Chunk &chunk,
+void MeshColumn::rebuildMesh(int index,
                              const world::ChunkColumn &chunkColumn,
-                             TextureAtlas &atlas) {
-    int index = chunk.coord().y;
-    auto neighbours = chunkColumn.adjacentChunks(index);
+                             world::MeshingMode mode) {
+    if (!((render_mask_ >> index) & 1u)) return;
+    versions_[index] = world::ChunkSnapshot::currentVersions(chunkColumn, index);
     auto &mesh_ptr = meshes_[index];
 
-    if (mesh_ptr) mesh_ptr->rebuild(chunk, neighbours, atlas);
-    else mesh_ptr = std::make_unique<ChunkMesh>(chunk, neighbours, atlas);
+    const world::Chunk *chunk = chunkColumn.chunks()[index].get();
+    if (!chunk) {
+        mesh_ptr.reset();
+        return;
+    }
+
+    auto neighbours = chunkColumn.adjacentChunks(index);
+    if (mesh_ptr) mesh_ptr->rebuild(*chunk, neighbours, mode);
+    else mesh_ptr = std::make_unique<ChunkMesh>(*chunk, neighbours, mode);
 
     if (mesh_ptr->isEmpty()) mesh_ptr.reset();
 }
@@ -1,31 +1,57 @@
 #pragma once
 #include <array>
 #include <memory>
+#include <span>
 
+#include "../../common/core/JobSystem.h"
 #include "../../common/world/WorldConstants.h"
 #include "../../common/world/ChunkColumn.h"
+#include "../../common/world/ChunkSnapshot.h"
 #include "ChunkMesh.h"
-#include "TextureAtlas.h"
 
 namespace mc::gfx {
     class MeshColumn {
     public:
         MeshColumn() = delete;
 
-        MeshColumn(const world::ChunkColumn &chunkColumn, TextureAtlas &atlas) {
-            generate(chunkColumn, atlas);
+        MeshColumn(const glm::ivec2 &coord, world::ChunkMask renderMask) : coord_{coord}, render_mask_{renderMask} {
         }
 
-        void rebuildMesh(const world::Chunk &chunk,
+        // meshes pinned snapshots (CPU side only, safe on a worker while the live chunks are edited);
+        // the meshes still need buildLayers on the render thread. false when cancel was raised between two meshes
+        bool build(std::span<const world::ChunkSnapshot> snapshots, world::MeshingMode mode,
+                   const core::CancelToken *cancel = nullptr);
+
+        // drops meshes leaving renderMask, returns the chunks entering it, which still need snapshots built
+        world::ChunkMask setRenderMask(world::ChunkMask renderMask);
+
+        // rendered chunks whose mesh was built from versions the column has moved past since
+        world::ChunkMask staleMeshes(const world::ChunkColumn &chunkColumn) const;
+
+        void buildLayers(world::ChunkMask mask = world::ALL_CHUNKS);
+
+        // takes over the meshes of mask built into other (a detached column at the same coord), except where this
+        // column's mesh is already built from chunkColumn's current versions; returns the ones taken
+        world::ChunkMask adoptMeshes(MeshColumn &other, world::ChunkMask mask, const world::ChunkColumn &chunkColumn);
+
+        std::size_t pendingUploadBytes(world::ChunkMask mask = world::ALL_CHUNKS) const;
+
+        // remeshes index from the live column, render thread only
+        void rebuildMesh(int index,
                          const world::ChunkColumn &chunkColumn,
-                         TextureAtlas &atlas);
+                         world::MeshingMode mode);
+
+        const glm::ivec2 &coord() const { return coord_; }
+
+        world::ChunkMask renderMask() const { return render_mask_; }
 
         auto &meshes() { return meshes_; }
         const auto &meshes() const { return meshes_; }
 
     private:
+        glm::ivec2 coord_;
         std::array<std::unique_ptr<ChunkMesh>, world::CHUNKS_PER_COLUMN> meshes_{};
-
-        void generate(const world::ChunkColumn &chunkColumn, TextureAtlas &atlas);
+        std::array<world::ChunkVersions, world::CHUNKS_PER_COLUMN> versions_{}; // what each mesh was built from
+        world::ChunkMask render_mask_ = 0;
     };
 }
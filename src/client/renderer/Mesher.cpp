@@ -1,4 +1,10 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+
 #include "Mesher.h"
+#include "PaddedOccupancy.h"
 
 using namespace mc::world;
 
@@ -21,75 +27,225 @@ constexpr glm::ivec3 QUAD[DIRECTIONS_COUNT][4] = {
 constexpr std::uint32_t Q[DIRECTIONS_COUNT] = {0, 1, 2, 0, 2, 3};
 
 namespace {
-    std::array<glm::vec2, 4> quadUV(int tile, int tilesPerRow) {
-        float step = 1.f / static_cast<float>(tilesPerRow);
-        float x = (tile % tilesPerRow) * step;
-        float y = (tile / tilesPerRow) * step;
+    // the axes a quad spans: u from its vertex 0 to 3, v from its vertex 0 to 1
+    constexpr int U_AXIS[DIRECTIONS_COUNT] = {2, 2, 0, 0, 0, 0};
+    constexpr int V_AXIS[DIRECTIONS_COUNT] = {1, 1, 2, 2, 1, 1};
+
+    constexpr glm::ivec2 QUAD_UV[4] = {{0, 0}, {0, 1}, {1, 1}, {1, 0}};
+
+    struct AtomicMeshingStats {
+        std::atomic<std::uint64_t> chunks{0}, vertices{0}, indices{0}, mesh_ns{0};
+    };
+
+    std::array<AtomicMeshingStats, MESHING_MODES_COUNT> meshing_stats;
+
+    // the masks below take leaves for the only opaque blocks that do not occlude, and for the cutout layer
+    static_assert([] {
+        for (std::size_t i = 0; i < NUM_BLOCKS; ++i) {
+            bool cutout = RENDER_LAYER_LUT[i] == RenderLayer::Cutout;
+            if (LEAVES_LUT[i] != (OPAQUE_LUT[i] && !OCCLUDING_LUT[i]) || cutout != LEAVES_LUT[i]) return false;
+        }
+        return true;
+    }());
+
+    // even direction indices are canonical (0, 2, 4) for +X, +Y, +Z
+    bool isCanonicalDirection(Direction direction) { return (directionToIndex(direction) & 1) == 0; }
+
+    struct VisibleFaces {
+        std::uint32_t occluding, cutout;
+    };
+
+    // bit x set where the block at (x, y, z) shows its face towards direction: an occluding block unless the
+    // adjacent one occludes, leaves the same, except that of two touching leaves only the non-canonical face shows
+    VisibleFaces visibleFaces(const PaddedOccupancy &padded, int y, int z, Direction direction) {
+        int row = PaddedOccupancy::row(y, z);
+        std::uint64_t opaque = padded.opaque[row], occluding = padded.occluding[row];
+        if (opaque == 0) return {0, 0};
+
+        std::uint64_t adjacent_opaque, adjacent_occluding;
+        switch (direction) {
+            case Direction::PositiveX:
+                adjacent_opaque = opaque >> 1;
+                adjacent_occluding = occluding >> 1;
+                break;
+            case Direction::NegativeX:
+                adjacent_opaque = opaque << 1;
+                adjacent_occluding = occluding << 1;
+                break;
+            default: {
+                glm::ivec3 offset = directionToNormalOffset(direction);
+                int adjacent_row = row + offset.y * PADDED_XYZ + offset.z;
+                adjacent_opaque = padded.opaque[adjacent_row];
+                adjacent_occluding = padded.occluding[adjacent_row];
+            }
+        }
+
+        std::uint64_t leaves = opaque & ~occluding;
+        std::uint64_t cutout = leaves & ~(isCanonicalDirection(direction) ? adjacent_opaque : adjacent_occluding);
         return {
-            glm::vec2{x, y},
-            glm::vec2{x, y + step},
-            glm::vec2{x + step, y + step},
-            glm::vec2{x + step, y}
+            static_cast<std::uint32_t>((occluding & ~adjacent_occluding) >> 1),
+            static_cast<std::uint32_t>(cutout >> 1)
         };
     }
 
-    // even direction indices are canonical (0, 2, 4) for +X, +Y, +Z
-    bool isCanonicalDirection(Direction direction) { return (directionToIndex(direction) & 1) == 0; }
+    constexpr std::array<Vertex, 4> unitFace(int d) {
+        return {
+            Vertex(QUAD[d][0], DIRECTIONS[d], 0, QUAD_UV[0]), Vertex(QUAD[d][1], DIRECTIONS[d], 0, QUAD_UV[1]),
+            Vertex(QUAD[d][2], DIRECTIONS[d], 0, QUAD_UV[2]), Vertex(QUAD[d][3], DIRECTIONS[d], 0, QUAD_UV[3])
+        };
+    }
+
+    // the quad of a single block's face per direction, at the origin and without a tile
+    constexpr std::array<std::array<Vertex, 4>, DIRECTIONS_COUNT> UNIT_FACES = {
+        unitFace(0), unitFace(1), unitFace(2), unitFace(3), unitFace(4), unitFace(5)
+    };
+
+    void emitFace(MeshLayers &out, int bucket, const glm::ivec3 &localCoord, int d, int tile) {
+        std::vector<Vertex> &vertices = out.vertices[bucket];
+        auto base = static_cast<std::uint32_t>(vertices.size());
+        for (Vertex vertex: UNIT_FACES[d]) {
+            vertex.position += glm::u8vec3(localCoord);
+            vertex.texture |= static_cast<std::uint32_t>(tile) << 2 * Vertex::UV_BITS;
+            vertices.push_back(vertex);
+        }
+
+        std::vector<std::uint32_t> &indices = out.indices[bucket];
+        for (uint32_t q: Q) indices.push_back(base + q);
+    }
+
+    // a quad from origin spanning size blocks (1 along its normal), with tile repeated once per block
+    void emitQuad(MeshLayers &out, int bucket, const glm::ivec3 &origin, const glm::ivec3 &size, Direction direction,
+                  int tile) {
+        int d = directionToIndex(direction);
+        glm::ivec2 extent(size[U_AXIS[d]], size[V_AXIS[d]]);
+
+        std::vector<Vertex> &vertices = out.vertices[bucket];
+        auto base = static_cast<std::uint32_t>(vertices.size());
+        for (int v = 0; v < 4; ++v)
+            vertices.emplace_back(origin + QUAD[d][v] * size, direction, tile, QUAD_UV[v] * extent);
+
+        // two triangles 0-1-2 and 0-2-3
+        std::vector<std::uint32_t> &indices = out.indices[bucket];
+        for (uint32_t q: Q) indices.emplace_back(base + q);
+    }
+
+    // the occluding faces collected per direction for greedy merging: faces[slice][v] has bit u set for a visible
+    // face at (u, v) of that slice, whose tile is tiles[slice][v][u]. tiles are only read under a set bit, and
+    // mergeFaces clears every bit it merges, so the scratch is all clear again after each direction without a fill
+    struct GreedyScratch {
+        std::array<std::uint32_t, CHUNK_XYZ * CHUNK_XYZ> faces{};
+        std::array<std::uint16_t, CHUNK_VOLUME> tiles;
+    };
+
+    thread_local GreedyScratch greedy_scratch;
+
+    // merged per slice set in slices: the first unmerged face grows along u while the tile matches, then along v
+    // while the whole run below is faces of the same tile
+    void mergeFaces(GreedyScratch &scratch, std::uint32_t slices, Direction direction, MeshLayers &out) {
+        int d = directionToIndex(direction);
+        int normal_axis = d / 2, u_axis = U_AXIS[d], v_axis = V_AXIS[d];
+
+        for (; slices != 0; slices &= slices - 1) {
+            int slice = std::countr_zero(slices);
+            std::uint32_t *faces = scratch.faces.data() + slice * CHUNK_XYZ;
+            const std::uint16_t *tiles = scratch.tiles.data() + slice * CHUNK_SLICE_VOLUME;
+
+            for (int v = 0; v < CHUNK_XYZ; ++v)
+                while (faces[v] != 0) {
+                    int u = std::countr_zero(faces[v]);
+                    const std::uint16_t *row = tiles + v * CHUNK_XYZ;
+                    std::uint16_t tile = row[u];
+
+                    int width = 1;
+                    while (u + width < CHUNK_XYZ && (faces[v] >> (u + width) & 1u) && row[u + width] == tile) ++width;
+                    std::uint32_t run = FULL_ROW >> (CHUNK_XYZ - width) << u;
+
+                    int height = 1;
+                    while (v + height < CHUNK_XYZ && (faces[v + height] & run) == run &&
+                           std::all_of(tiles + (v + height) * CHUNK_XYZ + u,
+                                       tiles + (v + height) * CHUNK_XYZ + u + width,
+                                       [&](std::uint16_t other) { return other == tile; }))
+                        ++height;
+                    for (int merged = v; merged < v + height; ++merged) faces[merged] &= ~run;
+
+                    glm::ivec3 origin, size;
+                    origin[normal_axis] = slice;
+                    origin[u_axis] = u;
+                    origin[v_axis] = v;
+                    size[normal_axis] = 1;
+                    size[u_axis] = width;
+                    size[v_axis] = height;
+                    emitQuad(out, 0, origin, size, direction, tile);
+                }
+        }
+    }
 }
 
 MeshLayers Mesher::buildChunkMeshLayers(const Chunk &chunk,
-                                        const std::array<Chunk *, DIRECTIONS_COUNT> &neighbors,
-                                        gfx::TextureAtlas &textureAtlas) {
+                                        const AdjacentChunks &neighbors,
+                                        MeshingMode mode) {
+    auto start = std::chrono::steady_clock::now();
     MeshLayers out;
+
+    // buried chunk: every face is hidden by a uniform occluding neighbour
+    bool buried = chunk.isUniformOccluder() && std::ranges::all_of(neighbors, [](const Chunk *neighbor) {
+        return neighbor && neighbor->isUniformOccluder();
+    });
+    if (!buried) buildFaces(chunk, neighbors, mode, out);
+
+    AtomicMeshingStats &stats = meshing_stats[static_cast<std::size_t>(mode)];
+    stats.chunks += 1;
+    stats.vertices += out.vertices[0].size() + out.vertices[1].size();
+    stats.indices += out.indices[0].size() + out.indices[1].size();
+    stats.mesh_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    return out;
+}
+
+MeshingStats Mesher::stats(MeshingMode mode) {
+    const AtomicMeshingStats &stats = meshing_stats[static_cast<std::size_t>(mode)];
+    return {stats.chunks.load(), stats.vertices.load(), stats.indices.load(), stats.mesh_ns.load() / 1000};
+}
+
+void Mesher::buildFaces(const Chunk &chunk, const AdjacentChunks &neighbors, MeshingMode mode, MeshLayers &out) {
+    PaddedOccupancy padded = padOccupancy(chunk, neighbors);
+
     out.vertices[0].reserve(CHUNK_SLICE_VOLUME * 4 * 3);
     out.indices[0].reserve(CHUNK_SLICE_VOLUME * 6 * 3);
 
-    NeighborSideFaces neighbor_faces = chunk.collectNeighborSideFaces(neighbors);
-
-    for (int y = 0; y < CHUNK_XYZ; ++y)
-        for (int z = 0; z < CHUNK_XYZ; ++z)
-            for (int x = 0; x < CHUNK_XYZ; ++x) {
-                glm::ivec3 local_coord{x, y, z};
-                const Block &block = chunk.blockAt(local_coord);
-                if (!block.opaque()) continue;
-
-                int bucket = block.renderLayer() == RenderLayer::Occluding ? 0 : 1;
-                bool is_leaves = block.isLeaves();
-
-                for (Direction direction: DIRECTIONS) {
-                    glm::ivec3 adjacent_local_coord = local_coord + directionToNormalOffset(direction);
-
-                    const Block &adjacent_block =
-                            Chunk::inBounds(adjacent_local_coord)
-                                ? chunk.blockAt(adjacent_local_coord)
-                                : chunk.getNeighborBlock(neighbor_faces, adjacent_local_coord, direction);
-
-                    bool both_leaves = is_leaves && adjacent_block.isLeaves();
-                    bool skip_face = both_leaves
-                                         ? isCanonicalDirection(direction)
-                                         : adjacent_block.occluding();
-
-                    if (skip_face) continue;
-
-                    int tile = block.tile(direction);
-                    std::array<glm::vec2, 4> UV = quadUV(tile, textureAtlas.tiles_per_row());
-                    auto base = static_cast<std::uint32_t>(out.vertices[bucket].size());
-
-                    std::vector<Vertex> &vertices = out.vertices[bucket];
-                    for (int v = 0; v < 4; ++v) {
-                        const glm::ivec3 &offset = QUAD[directionToIndex(direction)][v];
-                        vertices.emplace_back(
-                            local_coord + offset,
-                            direction,
-                            UV[v]
-                        );
+    bool greedy = mode == MeshingMode::Greedy;
+
+    for (Direction direction: DIRECTIONS) {
+        int d = directionToIndex(direction);
+        int normal_axis = d / 2, u_axis = U_AXIS[d], v_axis = V_AXIS[d];
+        std::uint32_t slices = 0;
+
+        for (int y = 0; y < CHUNK_XYZ; ++y)
+            for (int z = 0; z < CHUNK_XYZ; ++z) {
+                VisibleFaces faces = visibleFaces(padded, y, z, direction);
+
+                for (std::uint32_t row = faces.occluding; row != 0; row &= row - 1) {
+                    glm::ivec3 local_coord{std::countr_zero(row), y, z};
+                    int tile = chunk.blockAt(local_coord).tile(direction);
+                    if (!greedy) {
+                        emitFace(out, 0, local_coord, d, tile);
+                        continue;
                     }
 
-                    // two triangles 0-1-2 and 0-2-3
-                    std::vector<std::uint32_t> &indices = out.indices[bucket];
-                    for (uint32_t q: Q) indices.emplace_back(base + q);
+                    // collected for mergeFaces
+                    int slice = local_coord[normal_axis], u = local_coord[u_axis];
+                    int plane_row = slice * CHUNK_XYZ + local_coord[v_axis];
+                    greedy_scratch.faces[plane_row] |= 1u << u;
+                    greedy_scratch.tiles[plane_row * CHUNK_XYZ + u] = static_cast<std::uint16_t>(tile);
+                    slices |= 1u << slice;
+                }
+
+                for (std::uint32_t row = faces.cutout; row != 0; row &= row - 1) {
+                    glm::ivec3 local_coord{std::countr_zero(row), y, z};
+                    emitFace(out, 1, local_coord, d, chunk.blockAt(local_coord).tile(direction));
                 }
             }
 
-    return out;
+        if (greedy) mergeFaces(greedy_scratch, slices, direction, out);
+    }
 }
@@ -1,7 +1,7 @@
 #pragma once
+#include <cstdint>
 #include <vector>
 
-#include "TextureAtlas.h"
 #include "Vertex.h"
 #include "../../common/world/Chunk.h"
 #include "../../common/world/World.h"
@@ -12,10 +12,38 @@ namespace mc::world {
         std::array<std::vector<std::uint32_t>, 2> indices;
     };
 
+    // PerFace: a quad per visible face. Greedy: coplanar faces of the occluding layer sharing a tile merge into
+    // maximal rectangles, the cutout layer stays per face
+    enum class MeshingMode : std::uint8_t {
+        PerFace,
+        Greedy
+    };
+
+    constexpr int MESHING_MODES_COUNT = 2;
+
+    constexpr const char *meshingModeName(MeshingMode mode) {
+        switch (mode) {
+            case MeshingMode::PerFace: return "per-face";
+            case MeshingMode::Greedy: return "greedy";
+        }
+        return "unknown";
+    }
+
+    struct MeshingStats {
+        std::uint64_t chunks = 0, vertices = 0, indices = 0, mesh_us = 0;
+    };
+
     class Mesher {
     public:
+        // vertices carry tile indices, the shader finds them in the atlas
         static MeshLayers buildChunkMeshLayers(const Chunk &chunk,
-                                               const std::array<Chunk *, DIRECTIONS_COUNT> &neighbors,
-                                               gfx::TextureAtlas &textureAtlas);
+                                               const AdjacentChunks &neighbors,
+                                               MeshingMode mode);
+
+        // every chunk meshed in mode so far, by any thread
+        static MeshingStats stats(MeshingMode mode);
+
+    private:
+        static void buildFaces(const Chunk &chunk, const AdjacentChunks &neighbors, MeshingMode mode, MeshLayers &out);
     };
 }
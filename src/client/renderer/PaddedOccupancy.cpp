@@ -0,0 +1,54 @@
+#include "PaddedOccupancy.h"
+
+using namespace mc::world;
+
+PaddedOccupancy mc::world::padOccupancy(const Chunk &chunk, const AdjacentChunks &neighbors) {
+    PaddedOccupancy padded;
+    auto pad = [&](const OccupancyMasks &masks, auto place) {
+        OccupancyRows opaque = masks.opaque(), occluding = masks.occluding();
+        for (int y = 0; y < CHUNK_XYZ; ++y)
+            for (int z = 0; z < CHUNK_XYZ; ++z) {
+                int row = OccupancyMasks::rowIndex(y, z);
+                place(y, z, std::uint64_t{opaque[row]}, std::uint64_t{occluding[row]});
+            }
+    };
+    auto neighbor = [&](Direction direction) { return neighbors[directionToIndex(direction)]; };
+
+    pad(chunk.occupancy(), [&](int y, int z, std::uint64_t opaque, std::uint64_t occluding) {
+        int row = PaddedOccupancy::row(y, z);
+        padded.opaque[row] = opaque << 1;
+        padded.occluding[row] = occluding << 1;
+    });
+
+    // the x neighbours give a bit per row, the others a row per row of the facing plane
+    if (const Chunk *positive_x = neighbor(Direction::PositiveX))
+        pad(positive_x->occupancy(), [&](int y, int z, std::uint64_t opaque, std::uint64_t occluding) {
+            int row = PaddedOccupancy::row(y, z);
+            padded.opaque[row] |= (opaque & 1) << (CHUNK_XYZ + 1);
+            padded.occluding[row] |= (occluding & 1) << (CHUNK_XYZ + 1);
+        });
+    if (const Chunk *negative_x = neighbor(Direction::NegativeX))
+        pad(negative_x->occupancy(), [&](int y, int z, std::uint64_t opaque, std::uint64_t occluding) {
+            int row = PaddedOccupancy::row(y, z);
+            padded.opaque[row] |= opaque >> LAST;
+            padded.occluding[row] |= occluding >> LAST;
+        });
+
+    auto pad_plane = [&](Direction direction, int from, int to) {
+        const Chunk *adjacent = neighbor(direction);
+        if (!adjacent) return;
+        OccupancyRows opaque = adjacent->occupancy().opaque(), occluding = adjacent->occupancy().occluding();
+        bool along_y = direction == Direction::PositiveY || direction == Direction::NegativeY;
+        for (int i = 0; i < CHUNK_XYZ; ++i) {
+            int from_row = along_y ? OccupancyMasks::rowIndex(from, i) : OccupancyMasks::rowIndex(i, from);
+            int to_row = along_y ? PaddedOccupancy::row(to, i) : PaddedOccupancy::row(i, to);
+            padded.opaque[to_row] = std::uint64_t{opaque[from_row]} << 1;
+            padded.occluding[to_row] = std::uint64_t{occluding[from_row]} << 1;
+        }
+    };
+    pad_plane(Direction::PositiveY, 0, CHUNK_XYZ);
+    pad_plane(Direction::NegativeY, LAST, -1);
+    pad_plane(Direction::PositiveZ, 0, CHUNK_XYZ);
+    pad_plane(Direction::NegativeZ, LAST, -1);
+    return padded;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+#include "../../common/world/Chunk.h"
+
+namespace mc::world {
+    constexpr int PADDED_XYZ = CHUNK_XYZ + 2;
+
+    // the chunk's opaque and occluding voxels as x rows, surrounded by a voxel of each neighbour: row
+    // (y + 1) * PADDED_XYZ + z + 1 holds x at bit x + 1, for x, y and z from -1 to CHUNK_XYZ
+    struct PaddedOccupancy {
+        std::array<std::uint64_t, PADDED_XYZ * PADDED_XYZ> opaque{}, occluding{};
+
+        static constexpr int row(int y, int z) { return (y + 1) * PADDED_XYZ + z + 1; }
+    };
+
+    // straight from the occupancy rows of the chunk and its neighbours, only the voxels facing the chunk are taken
+    // from those; a missing neighbour stays clear, like air
+    PaddedOccupancy padOccupancy(const Chunk &chunk, const AdjacentChunks &neighbors);
+}
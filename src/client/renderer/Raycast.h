@@ -2,6 +2,7 @@
 #include <optional>
 #include <glm/glm.hpp>
 
+#include "../../common/world/BlockAccessor.h"
 #include "../../common/world/Chunk.h"
 #include "../../common/world/World.h"
 
@@ -33,10 +34,10 @@ namespace mc::world {
 
         float travelled = 0.f;
         int last_axis = -1;
+        BlockAccessor accessor(world, cell);
 
         while (travelled <= maxDist) {
-            ChunkLookup lookup = world.chunkLookup(cell);
-            if (lookup.chunk && lookup.chunk->blockAt(lookup.local_coord).opaque()) {
+            if (accessor.isOpaque()) {
                 glm::ivec3 normal = last_axis == -1 ? -step : step * AXIS_UNIT[last_axis];
                 return RayHit{cell, normal};
             }
@@ -47,6 +48,7 @@ namespace mc::world {
                            : t_max.y < t_max.z ? 1 : 2;
 
             cell[axis] += step[axis];
+            accessor.step(axisDirection(axis, step[axis]));
             travelled = t_max[axis];
             t_max[axis] += t_delta[axis];
             last_axis = axis;
@@ -1,9 +1,11 @@
+#include <algorithm>
+#include <bit>
 #include <ranges>
 #include <spdlog/spdlog.h>
 #include <glm/gtc/type_ptr.hpp>
-#include <future>
 
 #include "Renderer.h"
+#include "../common/world/BlockAccessor.h"
 #include "../common/world/Chunk.h"
 #include "core/Frustum.h"
 
@@ -11,7 +13,8 @@ using namespace mc::gfx;
 using mc::world::Chunk;
 
 Renderer::Renderer()
-    : texture_atlas_("resources/textures/atlases/block_atlas.png"),
+    : world_(jobs_),
+      texture_atlas_("resources/textures/atlases/block_atlas.png"),
       default_shader_("renderer/shaders/basic.vert",
                       "renderer/shaders/basic.frag"),
       outline_shader_("renderer/shaders/outline.vert",
@@ -19,7 +22,6 @@ Renderer::Renderer()
       hud_shader_("renderer/shaders/hud.vert",
                   "renderer/shaders/hud.frag") {
     initUniformLocations();
-    mesh_columns_.reserve(world::RENDER_AREA_SIZE);
 
     // --- build a unit-cube edge VAO (24 vertices) --------------------------
     constexpr float v[72] = {
@@ -51,9 +53,14 @@ Renderer::Renderer()
     glVertexArrayAttribBinding(hud_vao_, 0, 0);
 }
 
+Renderer::~Renderer() {
+    drainMeshing();
+}
+
 void Renderer::initUniformLocations() {
     uniforms_.u_MVP = glGetUniformLocation(default_shader_.id(), "uMVP");
     uniforms_.u_texture = glGetUniformLocation(default_shader_.id(), "uTexture");
+    uniforms_.u_tiles_per_row = glGetUniformLocation(default_shader_.id(), "uTilesPerRow");
     uniforms_.u_light_direction = glGetUniformLocation(default_shader_.id(), "uLightDirection");
     uniforms_.u_fog_color = glGetUniformLocation(default_shader_.id(), "uFogColor");
     uniforms_.u_fog_start = glGetUniformLocation(default_shader_.id(), "uFogStart");
@@ -76,8 +83,8 @@ void Renderer::renderFrame(const core::Camera &camera) {
     std::vector<std::pair<float, ChunkMesh *> > visible_meshes;
     visible_meshes.reserve(world::RENDER_AREA_SIZE * world::CHUNKS_PER_COLUMN / 4);
 
-    for (auto &mesh_column: mesh_columns_ | std::views::values)
-        for (auto &mesh_ptr: mesh_column->meshes())
+    for (MeshColumn &mesh_column: mesh_columns_.values())
+        for (auto &mesh_ptr: mesh_column.meshes())
             if (mesh_ptr && frustum.intersectsAABB(mesh_ptr->aabb_min(), mesh_ptr->aabb_max())) {
                 glm::vec3 diff = camera.position() - glm::vec3(mesh_ptr->aabb_center());
                 visible_meshes.emplace_back(glm::dot(diff, diff), mesh_ptr.get());
@@ -94,6 +101,7 @@ void Renderer::renderFrame(const core::Camera &camera) {
     default_shader_.use();
     glUniformMatrix4fv(uniforms_.u_MVP, 1, GL_FALSE, glm::value_ptr(vp));
     glUniform1i(uniforms_.u_texture, 0);
+    glUniform1i(uniforms_.u_tiles_per_row, texture_atlas_.tiles_per_row());
     glm::vec3 light_dir = glm::normalize(glm::vec3(0.5f, 1.0f, 0.3f));
     glUniform3fv(uniforms_.u_light_direction, 1, glm::value_ptr(light_dir));
     constexpr auto fog_color = glm::vec3(0.73f, 0.80f, 0.85f);
@@ -141,128 +149,360 @@ void Renderer::renderFrame(const core::Camera &camera) {
 }
 
 void Renderer::regenerateTerrain(int seed) {
+    drainMeshing();
     mesh_columns_.clear();
     world_.setSeed(seed);
 }
 
 void Renderer::toggleTerrainGenerationMode() {
+    drainMeshing();
     mesh_columns_.clear();
     world_.toggleTerrainMode();
-    spdlog::info("Terrain mode is now {}", world_.terrain_generation_mode() == world::TerrainGenerationMode::SineWave
-                                               ? "Sine-wave"
-                                               : "Perlin noise");
+    spdlog::info("Terrain mode is now {}", world::terrainModeName(world_.terrain_generation_mode()));
+}
+
+void Renderer::toggleMeshingMode() {
+    drainMeshing();
+    mesh_columns_.clear();
+    meshing_mode_ = static_cast<world::MeshingMode>((static_cast<int>(meshing_mode_) + 1) % world::MESHING_MODES_COUNT);
+    spdlog::info("Meshing mode is now {}", world::meshingModeName(meshing_mode_));
+
+    // nothing streams in when the camera stays put, so every loaded column is queued here
+    for (const world::ChunkColumn &column: world_.chunk_columns().values()) scheduleMeshes(column);
 }
 
 void Renderer::streamMeshColumns(const core::Camera &camera) {
-    auto start = std::chrono::high_resolution_clock::now();
+    auto start = std::chrono::steady_clock::now();
+
+    glm::ivec3 camera_chunk = glm::ivec3(glm::floor(camera.position())) >> world::CHUNK_BITS;
+    glm::ivec2 centre(camera_chunk.x, camera_chunk.z);
+    glm::vec3 velocity = camera.velocity();
+
+    // the camera turns and moves between frames, so waiting loads and meshes are re-scored every one
+    priority_ = world::StreamPriority(camera.position(), glm::vec2(velocity.x, velocity.z),
+                                      core::Frustum(camera.viewProjection()), camera_chunk.y);
+    world_.prioritise(priority_);
+    mesh_queue_.rescore([&](const MeshRequest &request) { return priority_(request.coord); });
+    world_.streamChunkColumns(camera_chunk, glm::vec2(velocity.x, velocity.z));
+
+    if (centre != mesh_centre_) {
+        mesh_centre_ = centre;
+        mesh_columns_.eraseIf([&](const glm::ivec2 &columnCoord) { return !inRenderRadius(columnCoord); });
+        cancelMeshes(false);
+    }
+    if (camera_chunk.y != mesh_centre_y_) updateMeshColumnsVertically(camera_chunk.y);
 
-    glm::ivec2 centre = world_.worldToColumn(glm::floor(camera.position()));
-    std::vector<world::ChunkColumn *> created_chunk_columns = world_.streamChunkColumns(centre);
-    if (created_chunk_columns.empty()) return;
+    for (const world::ChunkColumn *column: world_.integrateColumns()) scheduleMeshes(*column);
+    integrateMeshes();
 
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    if (!wave_.active) {
+        if (!world_.streaming() && meshing_.empty()) return;
+        wave_ = {};
+        wave_.active = true;
+        wave_.start = start;
+    }
+    wave_.frames += 1;
+    wave_.worst_frame_us = std::max<std::uint64_t>(
+        wave_.worst_frame_us, std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    if (!world_.streaming() && meshing_.empty()) logStreamingWave();
+}
 
-    spdlog::info("ChunkColumn streaming took {} ms", duration.count());
+void Renderer::logStreamingWave() {
+    wave_.active = false;
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - wave_.start);
+
+    world::ChunkPoolStats pool_stats = world_.poolStats();
+    spdlog::info("ChunkColumn streaming took {} ms over {} frames, at most {:.2f} ms of a frame ({:.1f} MiB resident)",
+                 duration.count(), wave_.frames, static_cast<double>(wave_.worst_frame_us) / 1000.0,
+                 static_cast<double>(world_.memoryUsage()) / (1024.0 * 1024.0));
+    spdlog::info("Chunk pool: columns {}/{} hit/miss, chunks {}/{} hit/miss, {} dropped, {:.1f} MiB pooled",
+                 pool_stats.column_hits, pool_stats.column_misses, pool_stats.chunk_hits, pool_stats.chunk_misses,
+                 pool_stats.dropped, static_cast<double>(pool_stats.bytes_pooled) / (1024.0 * 1024.0));
+
+    world::PersistenceStats persistence_stats = world_.persistenceStats();
+    auto perSecond = [](std::uint64_t count, std::uint64_t us) {
+        return us ? static_cast<double>(count) * 1e6 / static_cast<double>(us) : 0.0;
+    };
+    world::SaveStats save_stats = world_.saveStats();
+    spdlog::info("Chunks: {} loaded ({:.0f}/s), {} generated ({:.0f}/s)",
+                 persistence_stats.chunks_loaded, perSecond(persistence_stats.chunks_loaded, persistence_stats.load_us),
+                 persistence_stats.chunks_generated,
+                 perSecond(persistence_stats.chunks_generated, persistence_stats.generate_us));
+    spdlog::info("Columns: {} snapshotted ({:.0f}/s, {:.1f} MiB written)",
+                 save_stats.columns, perSecond(save_stats.columns, save_stats.write_us),
+                 static_cast<double>(save_stats.bytes) / (1024.0 * 1024.0));
+    spdlog::info("Edits: {} journaled, {} replayed", persistence_stats.edits_journaled,
+                 persistence_stats.edits_replayed);
+
+    world::StreamStats stream_stats = world_.takeStreamStats();
+    world::PrefetchStats prefetch_stats = world_.prefetchStats();
+    std::uint64_t prefetch_lookups = prefetch_stats.hits + prefetch_stats.misses;
+    world::ColdCacheStats cold_stats = world_.coldCacheStats();
+    std::uint64_t cold_lookups = cold_stats.hits + cold_stats.misses;
+    spdlog::info("Cold tier: {}/{} columns this wave, {:.1f}% hit rate overall, {} columns in {:.1f}/{:.1f} MiB, "
+                 "{} evicted", stream_stats.cold_hits, stream_stats.columns,
+                 cold_lookups ? 100.0 * static_cast<double>(cold_stats.hits) / cold_lookups : 0.0, cold_stats.columns,
+                 static_cast<double>(cold_stats.bytes) / (1024.0 * 1024.0),
+                 static_cast<double>(cold_stats.budget_bytes) / (1024.0 * 1024.0), cold_stats.evicted);
+    spdlog::info("Prefetch: {}/{} columns this wave ({:.2f} ms I/O wait), {:.1f}% hit rate overall, "
+                 "{} queued reads rejected",
+                 stream_stats.prefetch_hits, stream_stats.columns,
+                 static_cast<double>(stream_stats.io_wait_us) / 1000.0,
+                 prefetch_lookups ? 100.0 * static_cast<double>(prefetch_stats.hits) / prefetch_lookups : 0.0,
+                 prefetch_stats.rejected);
+
+    spdlog::info("Meshes: {} uploaded ({:.1f} MiB), {} of them stale or entering the vertical window", wave_.meshes,
+                 static_cast<double>(wave_.bytes) / (1024.0 * 1024.0), wave_.remeshed);
+    for (int mode = 0; mode < world::MESHING_MODES_COUNT; ++mode) {
+        world::MeshingStats meshing_stats = world::Mesher::stats(static_cast<world::MeshingMode>(mode));
+        if (!meshing_stats.chunks) continue;
+        auto chunks = static_cast<double>(meshing_stats.chunks);
+        spdlog::info("Meshing ({}) overall: {} chunks, per chunk {:.0f} vertices, {:.0f} indices, {:.1f} us",
+                     world::meshingModeName(static_cast<world::MeshingMode>(mode)), meshing_stats.chunks,
+                     static_cast<double>(meshing_stats.vertices) / chunks,
+                     static_cast<double>(meshing_stats.indices) / chunks,
+                     static_cast<double>(meshing_stats.mesh_us) / chunks);
+    }
 
-    std::erase_if(mesh_columns_, [&](const auto &kv) {
-        glm::ivec2 d = kv.first - centre;
-        return d.x * d.x + d.y * d.y > world::RENDER_RADIUS * world::RENDER_RADIUS;
-    });
+    core::CancelStats load_cancels = world_.cancelStats(), mesh_cancels = mesh_cancels_.stats();
+    core::CancelStats cancels = load_cancels;
+    cancels += mesh_cancels;
+    spdlog::info("Cancelled overall: {} loads ({} partway), {} mesh builds ({} partway), {:.1f} ms of worker time "
+                 "saved, {:.1f} ms spent on them", load_cancels.cancelled, load_cancels.running,
+                 mesh_cancels.cancelled, mesh_cancels.running, static_cast<double>(cancels.saved_us) / 1000.0,
+                 static_cast<double>(cancels.wasted_us) / 1000.0);
+
+    core::JobSystemStats job_stats = jobs_.stats();
+    std::vector<double> utilisation = job_stats.utilisation(last_job_stats_);
+    std::uint64_t jobs_run = 0, stolen = 0;
+    std::string shares;
+    for (std::size_t i = 0; i < job_stats.workers.size(); ++i) {
+        jobs_run += job_stats.workers[i].jobs;
+        stolen += job_stats.workers[i].stolen;
+        shares += fmt::format("{}{:.0f}%", shares.empty() ? "" : " ", utilisation[i] * 100.0);
+    }
+    spdlog::info("Jobs: {} queued, {} run ({} stolen, {} helped by waiting threads), worker utilisation since "
+                 "last log: {}", job_stats.queued, jobs_run, stolen, job_stats.helped, shares);
+    last_job_stats_ = std::move(job_stats);
+}
 
-    std::vector<std::future<std::pair<glm::ivec2, std::unique_ptr<MeshColumn> > > > futures;
+void Renderer::autosave() {
+    for (const world::SaveCycle &cycle: world_.autosave()) {
+        world::SaveStats save_stats = world_.saveStats();
+        spdlog::info("Saved {} chunks in {} columns ({:.1f} KiB): {:.2f} ms capture, {:.1f} ms latency, "
+                     "{:.1f} ms throttled overall, {} failed", cycle.chunks, cycle.columns,
+                     static_cast<double>(cycle.bytes) / 1024.0, static_cast<double>(cycle.capture_us) / 1000.0,
+                     static_cast<double>(cycle.latency_us) / 1000.0,
+                     static_cast<double>(save_stats.throttled_us) / 1000.0, save_stats.failed);
+    }
+}
 
-    for (auto &offset: world::RENDER_RADIUS_OFFSETS) {
-        glm::ivec2 column_coord = centre + offset;
-        if (!mesh_columns_.contains(column_coord)) {
-            auto &column = world_.chunk_columns().at(column_coord);
+void Renderer::updateMeshColumnsVertically(int centreChunkY) {
+    mesh_centre_y_ = centreChunkY;
+    world::ChunkMask render_mask = world::verticalMask(centreChunkY, world::VERTICAL_RENDER_RADIUS);
 
-            futures.emplace_back(std::async(
-                std::launch::async, [this, &column]() -> std::pair<glm::ivec2, std::unique_ptr<MeshColumn> > {
-                    auto mesh_column = std::make_unique<MeshColumn>(*column, texture_atlas_);
-                    return {column->coord(), std::move(mesh_column)};
-                }));
-        }
+    // entering chunks have no mesh yet, so they come up stale
+    for (MeshColumn &mesh_column: mesh_columns_.values()) {
+        mesh_column.setRenderMask(render_mask);
+        if (const world::ChunkColumn *column = world_.findColumn(mesh_column.coord())) scheduleMeshes(*column);
     }
 
-    for (auto &f: futures) {
-        auto [coord, mesh_column] = f.get();
+    // first builds were meshing the old window
+    std::vector<glm::ivec2> first_builds;
+    for (const glm::ivec2 &column_coord: meshing_ | std::views::keys)
+        if (!mesh_columns_.contains(column_coord)) first_builds.push_back(column_coord);
+    for (const glm::ivec2 &column_coord: first_builds)
+        if (const world::ChunkColumn *column = world_.findColumn(column_coord)) scheduleMeshes(*column);
+    unqueueCancelledMeshes();
+}
 
-        for (auto &mesh_ptr: mesh_column->meshes())
-            if (mesh_ptr) mesh_ptr->buildLayers();
+void Renderer::scheduleMeshes(const world::ChunkColumn &column) {
+    if (column.stage() != world::GenerationStage::Ready || !inRenderRadius(column.coord())) return;
 
-        mesh_columns_.emplace(coord, std::move(mesh_column));
+    const glm::ivec2 &column_coord = column.coord();
+    world::ChunkMask render_mask = world::verticalMask(mesh_centre_y_, world::VERTICAL_RENDER_RADIUS);
+    const MeshColumn *mesh_column = mesh_columns_.find(column_coord);
+    auto meshing = meshing_.find(column_coord);
+
+    world::ChunkMask mask = mesh_column ? mesh_column->staleMeshes(column) : render_mask;
+    if (!mask) return;
+    if (meshing != meshing_.end()) {
+        if (!(mask & ~meshing->second.chunks)) return;
+        meshing->second.cancel.cancel();
     }
+    core::CancelToken cancel;
+    meshing_.insert_or_assign(column_coord, Meshing{mask, cancel});
+
+    // workers only ever see snapshots, edits landing meanwhile show up as stale versions once it is integrated
+    mesh_queue_.push({column_coord, mask, render_mask, world::ChunkSnapshot::capture(column, mask), meshing_mode_,
+                      std::move(cancel)},
+                     priority_(column_coord));
+    meshes_in_flight_.emplace_back(jobs_.submit([this] { buildQueuedMeshes(); }));
+}
 
-    end = std::chrono::high_resolution_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+void Renderer::cancelMeshes(bool all) {
+    // erase_if hands out const entries, cancel() only raises the shared flag
+    std::erase_if(meshing_, [&](const auto &entry) {
+        if (!all && inRenderRadius(entry.first)) return false;
+        entry.second.cancel.cancel();
+        return true;
+    });
+    unqueueCancelledMeshes();
+}
 
-    spdlog::info("MeshColumn generation took {} ms", duration.count());
+void Renderer::unqueueCancelledMeshes() {
+    mesh_queue_.extractIf([](const MeshRequest &request) { return request.cancel.cancelled(); },
+                          [&](MeshRequest) { mesh_cancels_.cancelled(0, false); });
 }
 
-bool Renderer::breakBlock(const glm::ivec3 &worldCoord) {
-    world::ChunkLookup lookup = world_.chunkLookup(worldCoord);
-    if (!mesh_columns_.contains(lookup.chunk_column->coord())) return false;
-    if (!lookup.chunk || !lookup.chunk->blockAt(lookup.local_coord).opaque()) return false;
+void Renderer::buildQueuedMeshes() {
+    // one job per request, though not necessarily the one it was queued with
+    std::optional<MeshRequest> request = mesh_queue_.pop();
+    if (!request) return;
+    // cancelled since the last unqueueCancelledMeshes
+    if (request->cancel.cancelled()) {
+        mesh_cancels_.cancelled(0, false);
+        return;
+    }
 
-    lookup.chunk->setBlock(lookup.local_coord, world::BlockId::Air);
+    auto start = std::chrono::steady_clock::now();
+    auto meshes = std::make_unique<MeshColumn>(request->coord, request->render_mask);
+    bool built = meshes->build(request->snapshots, request->mode, &request->cancel);
+    auto ran_us = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    if (!built) {
+        mesh_cancels_.cancelled(ran_us, true);
+        return;
+    }
+    mesh_cancels_.finished(ran_us);
 
-    if (lookup.chunk->isEmpty()) {
-        mesh_columns_[lookup.chunk_column->coord()]->meshes()[lookup.index].reset();
-        lookup.chunk_column->chunks()[lookup.index].reset();
-    } else updateChunkMesh(*lookup.chunk, *lookup.chunk_column);
+    std::lock_guard lock(finished_mutex_);
+    finished_meshes_.push_back({std::move(meshes), request->chunks, std::move(request->cancel)});
+}
 
-    auto rebuildNeighbor = [&](world::Direction direction) {
-        auto [chunk, column] = lookup.chunk_column->adjacentChunkAndColumn(direction, lookup.index);
-        if (chunk) updateChunkMesh(*chunk, *column);
-    };
+void Renderer::integrateMeshes() {
+    auto start = std::chrono::steady_clock::now();
+
+    // a finished job has handed its meshes over already, get() only rethrows what a failed one threw
+    std::erase_if(meshes_in_flight_, [](core::JobHandle<void> &job) {
+        if (!job.ready()) return false;
+        job.get();
+        return true;
+    });
+
+    std::size_t bytes = 0;
+    do {
+        MeshBuild build;
+        {
+            std::lock_guard lock(finished_mutex_);
+            if (finished_meshes_.empty()) break;
+            build = std::move(finished_meshes_.front());
+            finished_meshes_.pop_front();
+        }
+
+        // superseded or left RENDER_RADIUS after it finished, its map entry is gone or belongs to the newer build
+        if (build.cancel.cancelled()) continue;
+
+        glm::ivec2 column_coord = build.meshes->coord();
+        meshing_.erase(column_coord);
+
+        const world::ChunkColumn *column = world_.findColumn(column_coord);
+        if (!column || !inRenderRadius(column_coord)) continue; // unloaded or left while meshing
+
+        world::ChunkMask uploaded;
+        MeshColumn *mesh_column = mesh_columns_.find(column_coord);
+        if (mesh_column) {
+            uploaded = mesh_column->adoptMeshes(*build.meshes, build.chunks, *column);
+            wave_.remeshed += std::popcount(uploaded);
+        } else {
+            mesh_column = build.meshes.get();
+            // a mesh column displaced from the slot holds nothing but meshes, destroying it releases their buffers
+            mesh_columns_.emplace(column_coord, std::move(build.meshes));
+            // built for the vertical window at the time it was queued
+            mesh_column->setRenderMask(world::verticalMask(mesh_centre_y_, world::VERTICAL_RENDER_RADIUS));
+            uploaded = build.chunks & mesh_column->renderMask();
+        }
+
+        std::size_t upload_bytes = mesh_column->pendingUploadBytes(uploaded);
+        mesh_column->buildLayers(uploaded);
+        bytes += upload_bytes;
+        wave_.meshes += std::popcount(uploaded);
+        wave_.bytes += upload_bytes;
+
+        // blocks loaded or edited while it was meshed
+        scheduleMeshes(*column);
+    } while (bytes < upload_budget_bytes_ &&
+             std::chrono::steady_clock::now() - start < upload_budget_);
+}
+
+void Renderer::drainMeshing() {
+    cancelMeshes(true);
+    for (auto &job: meshes_in_flight_) job.wait();
+    meshes_in_flight_.clear();
+    meshing_.clear();
 
-    if (lookup.local_coord.x == 0) rebuildNeighbor(world::Direction::NegativeX);
-    else if (lookup.local_coord.x == world::CHUNK_XYZ - 1) rebuildNeighbor(world::Direction::PositiveX);
-    if (lookup.local_coord.y == 0) rebuildNeighbor(world::Direction::NegativeY);
-    else if (lookup.local_coord.y == world::CHUNK_XYZ - 1) rebuildNeighbor(world::Direction::PositiveY);
-    if (lookup.local_coord.z == 0) rebuildNeighbor(world::Direction::NegativeZ);
-    else if (lookup.local_coord.z == world::CHUNK_XYZ - 1) rebuildNeighbor(world::Direction::PositiveZ);
+    std::lock_guard lock(finished_mutex_);
+    finished_meshes_.clear();
+}
+
+bool Renderer::breakBlock(const glm::ivec3 &worldCoord) {
+    world::BlockAccessor accessor(world_, worldCoord);
+    world::ChunkLookup lookup = accessor.lookup();
+    if (!lookup.chunk_column || !mesh_columns_.contains(lookup.chunk_column->coord())) return false;
+    if (!lookup.chunk || !lookup.chunk->isOpaque(lookup.local_coord)) return false;
 
+    lookup.chunk->setBlock(lookup.local_coord, world::BlockId::Air);
+    world_.recordEdit(worldCoord, world::BlockId::Air);
+
+    if (lookup.chunk->isEmpty()) world_.pool().release(std::move(lookup.chunk_column->chunks()[lookup.index]));
+    updateChunkMesh(lookup.index, *lookup.chunk_column);
+
+    rebuildBorderNeighbors(accessor);
     return true;
 }
 
 bool Renderer::placeBlock(const glm::ivec3 &worldCoord, world::BlockId blockId) {
-    world::ChunkLookup lookup = world_.chunkLookup(worldCoord);
+    world::BlockAccessor accessor(world_, worldCoord);
+    world::ChunkLookup lookup = accessor.lookup();
+    if (!lookup.chunk_column || lookup.index < 0 || !lookup.chunk_column->isLoaded(lookup.index)) return false;
     if (!mesh_columns_.contains(lookup.chunk_column->coord())) return false;
-    if (!lookup.chunk_column || lookup.index < 0) return false;
     if (!lookup.chunk && blockId == world::BlockId::Air) return false;
     if (lookup.chunk && lookup.chunk->blockAt(lookup.local_coord).id == blockId) return false;
 
-    if (lookup.chunk) {
-        lookup.chunk->setBlock(lookup.local_coord, blockId);
-        updateChunkMesh(*lookup.chunk, *lookup.chunk_column);
-    } else {
+    world_.recordEdit(worldCoord, blockId);
+    if (lookup.chunk) lookup.chunk->setBlock(lookup.local_coord, blockId);
+    else {
         auto &chunk_ptr = lookup.chunk_column->chunks()[lookup.index];
         glm::ivec3 chunk_coord = {lookup.chunk_column->coord().x, lookup.index, lookup.chunk_column->coord().y};
-        chunk_ptr = std::make_unique<Chunk>(chunk_coord);
+        chunk_ptr = world_.pool().acquireChunk(chunk_coord);
         chunk_ptr->setBlock(lookup.local_coord, blockId);
-        updateChunkMesh(*chunk_ptr, *lookup.chunk_column);
     }
+    updateChunkMesh(lookup.index, *lookup.chunk_column);
+
+    rebuildBorderNeighbors(accessor);
+    return true;
+}
+
+void Renderer::rebuildBorderNeighbors(const world::BlockAccessor &accessor) {
+    const glm::ivec3 &local_coord = accessor.lookup().local_coord;
 
     auto rebuildNeighbor = [&](world::Direction direction) {
-        auto [chunk, column] = lookup.chunk_column->adjacentChunkAndColumn(direction, lookup.index);
-        if (chunk) updateChunkMesh(*chunk, *column);
+        world::BlockAccessor neighbor = accessor;
+        neighbor.step(direction);
+        if (neighbor.chunk()) updateChunkMesh(neighbor.lookup().index, *neighbor.column());
     };
 
-    if (lookup.local_coord.x == 0) rebuildNeighbor(world::Direction::NegativeX);
-    else if (lookup.local_coord.x == world::CHUNK_XYZ - 1) rebuildNeighbor(world::Direction::PositiveX);
-    if (lookup.local_coord.y == 0) rebuildNeighbor(world::Direction::NegativeY);
-    else if (lookup.local_coord.y == world::CHUNK_XYZ - 1) rebuildNeighbor(world::Direction::PositiveY);
-    if (lookup.local_coord.z == 0) rebuildNeighbor(world::Direction::NegativeZ);
-    else if (lookup.local_coord.z == world::CHUNK_XYZ - 1) rebuildNeighbor(world::Direction::PositiveZ);
-
-    return true;
+    if (local_coord.x == 0) rebuildNeighbor(world::Direction::NegativeX);
+    else if (local_coord.x == world::CHUNK_XYZ - 1) rebuildNeighbor(world::Direction::PositiveX);
+    if (local_coord.y == 0) rebuildNeighbor(world::Direction::NegativeY);
+    else if (local_coord.y == world::CHUNK_XYZ - 1) rebuildNeighbor(world::Direction::PositiveY);
+    if (local_coord.z == 0) rebuildNeighbor(world::Direction::NegativeZ);
+    else if (local_coord.z == world::CHUNK_XYZ - 1) rebuildNeighbor(world::Direction::PositiveZ);
 }
 
-void Renderer::updateChunkMesh(const Chunk &chunk, const world::ChunkColumn &column) {
-    auto it = mesh_columns_.find(column.coord());
-    if (it == mesh_columns_.end()) return;
-
-    it->second->rebuildMesh(chunk, column, texture_atlas_);
+void Renderer::updateChunkMesh(int index, const world::ChunkColumn &column) {
+    if (MeshColumn *mesh_column = mesh_columns_.find(column.coord()))
+        mesh_column->rebuildMesh(index, column, meshing_mode_);
 }
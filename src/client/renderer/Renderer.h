@@ -1,20 +1,33 @@
 #pragma once
+#include <chrono>
+#include <deque>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <unordered_map>
 
 #include "Shader.h"
 #include "ChunkMesh.h"
 #include "MeshColumn.h"
 #include "TextureAtlas.h"
 #include "../../common/core/Camera.h"
+#include "../../common/core/JobSystem.h"
+#include "../../common/core/WorkQueue.h"
+#include "../../common/world/BlockAccessor.h"
 #include "../../common/world/World.h"
 
 namespace mc::gfx {
     class Renderer {
     public:
+        // time and mesh bytes streamMeshColumns may spend uploading per frame; at least one build goes up regardless
+        static constexpr std::chrono::microseconds DEFAULT_UPLOAD_BUDGET{3'000};
+        static constexpr std::size_t DEFAULT_UPLOAD_BUDGET_BYTES = 8u << 20;
+
         Renderer();
 
-        ~Renderer() = default;
+        // waits out the mesh jobs, which hand their meshes to it
+        ~Renderer();
 
         void renderFrame(const core::Camera &camera);
 
@@ -22,23 +35,40 @@ namespace mc::gfx {
 
         void toggleTerrainGenerationMode();
 
+        // remeshes everything in the next meshing mode
+        void toggleMeshingMode();
+
         bool breakBlock(const glm::ivec3 &worldCoord);
 
         bool placeBlock(const glm::ivec3 &worldCoord, world::BlockId blockId);
 
+        // queues loads and meshes around the camera and takes in whichever finished, within the world's integration
+        // budget and the upload budget; never waits on a worker, until then the frame shows what is ready
         void streamMeshColumns(const core::Camera &camera);
 
+        void setUploadBudget(std::chrono::microseconds budget, std::size_t bytes) {
+            upload_budget_ = budget;
+            upload_budget_bytes_ = bytes;
+        }
+
+        // starts a background save when one is due and logs the ones that finished
+        void autosave();
+
         const world::World &world() const { return world_; }
 
         void setHighlightBlock(const std::optional<glm::ivec3> &block) { highlight_block_ = block; }
 
     private:
+        // meshing and the world's generation share the workers; declared first so they outlive both
+        core::JobSystem jobs_;
+        core::JobSystemStats last_job_stats_;
         world::World world_;
 
         struct {
             // default shader (chunks)
             GLint u_MVP = -1;
             GLint u_texture = -1;
+            GLint u_tiles_per_row = -1;
             GLint u_light_direction = -1;
             GLint u_fog_color = -1;
             GLint u_fog_start = -1;
@@ -55,9 +85,52 @@ namespace mc::gfx {
 
         TextureAtlas texture_atlas_;
 
-        std::unordered_map<glm::ivec2,
-            std::unique_ptr<MeshColumn>,
-            world::ColumnHash> mesh_columns_;
+        world::ColumnRing<MeshColumn, world::RENDER_RADIUS> mesh_columns_;
+        glm::ivec2 mesh_centre_{std::numeric_limits<int>::min()};
+        int mesh_centre_y_ = std::numeric_limits<int>::min();
+
+        // snapshots of the chunks of mask waiting for a worker to mesh them
+        struct MeshRequest {
+            glm::ivec2 coord;
+            world::ChunkMask chunks, render_mask;
+            std::vector<world::ChunkSnapshot> snapshots;
+            world::MeshingMode mode;
+            core::CancelToken cancel;
+        };
+
+        // meshes of the chunks of mask built on a worker, adopted by the MeshColumn at their coord or becoming it
+        struct MeshBuild {
+            std::unique_ptr<MeshColumn> meshes;
+            world::ChunkMask chunks;
+            core::CancelToken cancel; // raised after it finished, it is dropped all the same
+        };
+
+        struct Meshing {
+            world::ChunkMask chunks;
+            core::CancelToken cancel;
+        };
+
+        core::WorkQueue<MeshRequest> mesh_queue_;
+        world::StreamPriority priority_;
+        world::MeshingMode meshing_mode_ = world::MeshingMode::Greedy;
+
+        // workers append, integrateMeshes takes from the front
+        std::mutex finished_mutex_;
+        std::deque<MeshBuild> finished_meshes_;
+        std::vector<core::JobHandle<void> > meshes_in_flight_; // one per request, each meshing the best one
+        // the one build queued or running per column, until integrateMeshes takes it in or it is cancelled
+        std::unordered_map<glm::ivec2, Meshing, world::ColumnHash> meshing_;
+        core::CancelLedger mesh_cancels_;
+        std::chrono::microseconds upload_budget_ = DEFAULT_UPLOAD_BUDGET;
+        std::size_t upload_budget_bytes_ = DEFAULT_UPLOAD_BUDGET_BYTES;
+
+        // from the frame loads or meshes got queued to the one the last of them went up
+        struct {
+            bool active = false;
+            std::chrono::steady_clock::time_point start;
+            std::uint64_t frames = 0, worst_frame_us = 0;
+            std::uint64_t meshes = 0, remeshed = 0, bytes = 0;
+        } wave_;
 
         Shader default_shader_;
 
@@ -70,9 +143,38 @@ namespace mc::gfx {
 
         void initUniformLocations();
 
+        bool inRenderRadius(const glm::ivec2 &columnCoord) const {
+            glm::ivec2 d = columnCoord - mesh_centre_;
+            return d.x * d.x + d.y * d.y <= world::RENDER_RADIUS * world::RENDER_RADIUS;
+        }
+
         void createMeshColumn(const world::ChunkColumn &column);
 
-        void updateChunkMesh(const world::Chunk &chunk,
-                             const world::ChunkColumn &column);
+        void updateMeshColumnsVertically(int centreChunkY);
+
+        // queues a build of column's missing or stale meshes from snapshots, unless one is running for them; one
+        // running for part of them is cancelled, the new build covers all of them from fresher snapshots
+        void scheduleMeshes(const world::ChunkColumn &column);
+
+        // cancels the builds of columns that left RENDER_RADIUS, or all of them, and drops those still queued
+        void cancelMeshes(bool all);
+
+        // drops the queued requests cancelled since the last call
+        void unqueueCancelledMeshes();
+
+        // on a worker: the queued request with the best score
+        void buildQueuedMeshes();
+
+        // uploads finished builds until the upload budget is spent
+        void integrateMeshes();
+
+        // waits out every queued build and drops the results
+        void drainMeshing();
+
+        void logStreamingWave();
+
+        void updateChunkMesh(int index, const world::ChunkColumn &column);
+
+        void rebuildBorderNeighbors(const world::BlockAccessor &accessor);
     };
 }
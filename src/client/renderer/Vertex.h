@@ -6,21 +6,24 @@
 
 namespace mc::world {
     struct Vertex {
+        static constexpr int UV_BITS = 6; // a quad spans at most CHUNK_XYZ blocks either way
+
         glm::u8vec3 position; // 3 B
         std::uint8_t packed_normal; // 1 B
-        glm::u16vec2 uv; // 4 B
+        std::uint32_t texture; // 4 B: atlas tile << 2 * UV_BITS | v << UV_BITS | u
 
-        // std::numeric_limits<std::uint16_t>::max() == 65535
-        Vertex(const glm::ivec3 &pos,
+        // uv in blocks across the quad, the shader repeats the tile once per block
+        constexpr Vertex(const glm::ivec3 &pos,
                Direction direction,
-               const glm::vec2 &uv)
+               int tile,
+               const glm::ivec2 &uv)
             : position(pos),
               packed_normal(packNormal(direction)),
-              uv(uv.x * std::numeric_limits<std::uint16_t>::max(),
-                 uv.y * std::numeric_limits<std::uint16_t>::max()) {
+              texture(static_cast<std::uint32_t>(tile) << 2 * UV_BITS |
+                      static_cast<std::uint32_t>(uv.y) << UV_BITS | static_cast<std::uint32_t>(uv.x)) {
         }
 
-        std::uint8_t packNormal(Direction direction) {
+        static constexpr std::uint8_t packNormal(Direction direction) {
             constexpr std::uint8_t LUT[DIRECTIONS_COUNT] = {
                 0b000001, 0b000010, 0b000100,
                 0b001000, 0b010000, 0b100000
@@ -2,9 +2,11 @@
 
 in vec3 vWorldPosition;
 in vec2 vUV;
+flat in vec2 vTileOrigin;
 in vec3 vNormal;
 
 uniform sampler2D uTexture;
+uniform int uTilesPerRow;
 uniform vec3 uLightDirection;
 uniform vec3 uCameraPosition;
 uniform vec3 uFogColor;
@@ -15,7 +17,7 @@ out vec4 FragColor;
 
 void main()
 {
-    vec4 tex = texture(uTexture, vUV);
+    vec4 tex = texture(uTexture, vTileOrigin + fract(vUV) / float(uTilesPerRow));
     if (tex.a < 0.05) discard;
 
     // lambert diffuse shading
@@ -1,13 +1,15 @@
 #version 460 core
 layout(location = 0) in uvec3 aPosition;
 layout(location = 1) in uint aPackedNormal;
-layout(location = 2) in vec2 aUV;
+layout(location = 2) in uint aTexture; // tile << 12 | v << 6 | u, u and v in blocks
 
 uniform ivec3 uChunkOrigin;
 uniform mat4 uMVP;
+uniform int uTilesPerRow;
 
 out vec3 vWorldPosition;
 out vec2 vUV;
+flat out vec2 vTileOrigin;
 out vec3 vNormal;
 
 void main()
@@ -15,7 +17,10 @@ void main()
     vWorldPosition = vec3(aPosition) + vec3(uChunkOrigin);
     gl_Position = uMVP * vec4(vWorldPosition, 1.0);
 
-    vUV = aUV;
+    // the fragment shader wraps uv into the tile, so a merged quad repeats it once per block
+    vUV = vec2(aTexture & 63u, (aTexture >> 6) & 63u);
+    uint tile = aTexture >> 12;
+    vTileOrigin = vec2(tile % uint(uTilesPerRow), tile / uint(uTilesPerRow)) / float(uTilesPerRow);
     uint bits = aPackedNormal;
     vNormal = vec3(
     (bits & 1u) - (bits & 2u),
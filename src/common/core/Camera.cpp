@@ -30,6 +30,16 @@ void Camera::handleKeyboard(bool forward, bool backward,
     if (right) position_ += right_ * velocity;
     if (space) position_ += world_up_ * velocity; // move up
     if (shift) position_ -= world_up_ * velocity; // move down
+    recordPosition(dt);
+}
+
+glm::vec3 Camera::velocity() const {
+    if (history_count_ < 2) return glm::vec3(0.0f);
+
+    const PositionSample &newest = position_history_[(history_next_ + HISTORY_SIZE - 1) % HISTORY_SIZE];
+    const PositionSample &oldest = position_history_[(history_next_ + HISTORY_SIZE - history_count_) % HISTORY_SIZE];
+    float elapsed = newest.time - oldest.time;
+    return elapsed > 0.0f ? (newest.position - oldest.position) / elapsed : glm::vec3(0.0f);
 }
 
 glm::mat4 Camera::view() const {
@@ -58,3 +68,10 @@ void Camera::updateVectors() {
     right_ = glm::normalize(glm::cross(world_up_, front_));
     up_ = glm::normalize(glm::cross(front_, right_));
 }
+
+void Camera::recordPosition(float dt) {
+    time_ += dt;
+    position_history_[history_next_] = {position_, time_};
+    history_next_ = (history_next_ + 1) % HISTORY_SIZE;
+    history_count_ = std::min(history_count_ + 1, HISTORY_SIZE);
+}
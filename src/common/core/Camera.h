@@ -1,4 +1,5 @@
 #pragma once
+#include <array>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -27,9 +28,26 @@ namespace mc::core {
 
         const glm::vec3 &front() const { return front_; }
 
+        // average over the recent position history, in blocks per second
+        glm::vec3 velocity() const;
+
     private:
         void updateVectors();
 
+        void recordPosition(float dt);
+
+        static constexpr int HISTORY_SIZE = 16;
+
+        struct PositionSample {
+            glm::vec3 position;
+            float time;
+        };
+
+        std::array<PositionSample, HISTORY_SIZE> position_history_{};
+        int history_next_ = 0;
+        int history_count_ = 0;
+        float time_ = 0.0f;
+
         glm::vec3 position_{0.0f, 30.0f, 0.0f};
         glm::vec3 front_{0.0f, 0.0f, 1.0f};
         glm::vec3 up_{0.0f, 1.0f, 0.0f};
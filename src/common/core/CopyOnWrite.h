@@ -0,0 +1,16 @@
+#pragma once
+#include <atomic>
+#include <memory>
+
+namespace mc::core {
+    // whether a copy-on-write payload has no other owner left and may be written in place. use_count() is a relaxed
+    // load, so on its own reading 1 orders nothing against the other owners' reads of the payload: a snapshot
+    // dropped on a worker could still be reading it. the acquire fence pairs with the release half of that owner's
+    // count decrement, which read 1 comes from, so its reads happen before the caller's writes
+    template<typename T>
+    bool soleOwner(const std::shared_ptr<T> &payload) {
+        if (payload.use_count() != 1) return false;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return true;
+    }
+}
@@ -0,0 +1,46 @@
+#include "FileSync.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace mc::core;
+
+namespace {
+#ifndef _WIN32
+    bool syncPath(const std::filesystem::path &path, int flags) {
+        int fd = ::open(path.c_str(), flags);
+        if (fd < 0) return false;
+        bool synced = ::fsync(fd) == 0;
+        ::close(fd);
+        return synced;
+    }
+#endif
+}
+
+bool mc::core::syncFile(const std::filesystem::path &path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    bool synced = FlushFileBuffers(file) != 0;
+    CloseHandle(file);
+    return synced;
+#else
+    return syncPath(path, O_RDONLY);
+#endif
+}
+
+bool mc::core::syncDirectory([[maybe_unused]] const std::filesystem::path &path) {
+#ifdef _WIN32
+    // NTFS journals renames and new entries itself, and directory handles cannot be flushed
+    return true;
+#else
+    return syncPath(path, O_RDONLY | O_DIRECTORY);
+#endif
+}
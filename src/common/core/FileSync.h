@@ -0,0 +1,11 @@
+#pragma once
+#include <filesystem>
+
+namespace mc::core {
+    // pushes what was written to the file at path, through any handle, out of the OS cache onto the disk;
+    // false when it could not be opened or synced
+    bool syncFile(const std::filesystem::path &path);
+
+    // the same for a directory's entries, so a file created or renamed into it survives a power loss
+    bool syncDirectory(const std::filesystem::path &path);
+}
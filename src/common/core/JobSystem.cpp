@@ -0,0 +1,128 @@
+#include "JobSystem.h"
+
+using namespace mc::core;
+
+namespace {
+    // the worker the calling thread is, if it belongs to a pool
+    thread_local const JobSystem *current_system = nullptr;
+    thread_local int current_worker = -1;
+
+    std::uint64_t elapsedMicroseconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+JobSystem::JobSystem(unsigned workerCount) {
+    workers_.reserve(workerCount);
+    for (unsigned i = 0; i < workerCount; ++i) workers_.emplace_back(std::make_unique<Worker>());
+    // started only once every deque exists, workers steal from each other from their first loop on
+    for (unsigned i = 0; i < workerCount; ++i)
+        workers_[i]->thread = std::thread([this, i] { workerLoop(static_cast<int>(i)); });
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto &worker: workers_) worker->thread.join();
+}
+
+JobSystemStats JobSystem::stats() const {
+    JobSystemStats stats{queued_.load(), helped_.load(), elapsedMicroseconds(started_), {}};
+    stats.workers.reserve(workers_.size());
+    for (const auto &worker: workers_)
+        stats.workers.push_back({worker->jobs.load(), worker->stolen.load(), worker->busy_us.load()});
+    return stats;
+}
+
+void JobSystem::wait(detail::JobStateBase &state) {
+    while (true) {
+        {
+            std::lock_guard lock(state.mutex);
+            if (state.done) return;
+        }
+        if (runOne()) continue;
+
+        // bounded, so a job queued meanwhile is helped with rather than left to busy workers
+        std::unique_lock lock(state.mutex);
+        state.finished.wait_for(lock, std::chrono::milliseconds(1), [&] { return state.done; });
+    }
+}
+
+void JobSystem::push(Job job, JobPriority priority) {
+    std::size_t target = current_system == this
+                             ? static_cast<std::size_t>(current_worker)
+                             : next_worker_++ % workers_.size();
+    // counted before a thief can see the job and count it off, so queued_ never dips below zero
+    queued_ += 1;
+    {
+        Worker &worker = *workers_[target];
+        std::lock_guard lock(worker.mutex);
+        worker.queues[static_cast<int>(priority)].emplace_back(std::move(job));
+    }
+    {
+        std::lock_guard lock(sleep_mutex_);
+    }
+    wake_.notify_one();
+}
+
+std::optional<JobSystem::Job> JobSystem::take(int self) {
+    int count = static_cast<int>(workers_.size());
+    for (int priority = 0; priority < JOB_PRIORITIES_COUNT; ++priority) {
+        if (self >= 0) {
+            Worker &worker = *workers_[self];
+            std::lock_guard lock(worker.mutex);
+            auto &queue = worker.queues[priority];
+            if (!queue.empty()) {
+                Job job = std::move(queue.back());
+                queue.pop_back();
+                queued_ -= 1;
+                return job;
+            }
+        }
+
+        int first = self >= 0 ? self + 1 : 0;
+        for (int k = 0; k < count; ++k) {
+            int victim = (first + k) % count;
+            if (victim == self) continue;
+            Worker &worker = *workers_[victim];
+            std::lock_guard lock(worker.mutex);
+            auto &queue = worker.queues[priority];
+            if (queue.empty()) continue;
+            Job job = std::move(queue.front());
+            queue.pop_front();
+            queued_ -= 1;
+            if (self >= 0) workers_[self]->stolen += 1;
+            return job;
+        }
+    }
+    return std::nullopt;
+}
+
+bool JobSystem::runOne() {
+    int self = current_system == this ? current_worker : -1;
+    std::optional<Job> job = take(self);
+    if (!job) return false;
+
+    auto start = std::chrono::steady_clock::now();
+    (*job)();
+    if (self >= 0) {
+        workers_[self]->jobs += 1;
+        workers_[self]->busy_us += elapsedMicroseconds(start);
+    } else helped_ += 1;
+    return true;
+}
+
+void JobSystem::workerLoop(int self) {
+    current_system = this;
+    current_worker = self;
+    while (true) {
+        if (runOne()) continue;
+
+        std::unique_lock lock(sleep_mutex_);
+        wake_.wait(lock, [&] { return stopping_ || queued_.load() > 0; });
+        if (stopping_ && queued_.load() == 0) return;
+    }
+}
@@ -0,0 +1,313 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace mc::core {
+    enum class JobPriority : std::uint8_t {
+        High = 0,
+        Normal = 1,
+        Low = 2
+    };
+
+    constexpr int JOB_PRIORITIES_COUNT = 3;
+
+    struct WorkerStats {
+        std::uint64_t jobs = 0, stolen = 0; // stolen: taken from another worker's queue
+        std::uint64_t busy_us = 0;
+    };
+
+    struct JobSystemStats {
+        std::size_t queued = 0;
+        std::uint64_t helped = 0; // jobs run by threads outside the pool while they waited on a handle
+        std::uint64_t uptime_us = 0;
+        std::vector<WorkerStats> workers;
+
+        // per worker, the share of the time since `since` spent running jobs
+        std::vector<double> utilisation(const JobSystemStats &since) const {
+            std::vector<double> shares(workers.size(), 0.0);
+            double elapsed = static_cast<double>(uptime_us - since.uptime_us);
+            for (std::size_t i = 0; i < workers.size() && elapsed > 0.0; ++i) {
+                std::uint64_t before = i < since.workers.size() ? since.workers[i].busy_us : 0;
+                shares[i] = static_cast<double>(workers[i].busy_us - before) / elapsed;
+            }
+            return shares;
+        }
+    };
+
+    // raised by whoever queued a job once its result is no longer wanted; the job polls it between steps and gives
+    // up early. copies share one flag
+    class CancelToken {
+    public:
+        CancelToken() : flag_{std::make_shared<std::atomic<bool> >(false)} {
+        }
+
+        void cancel() const { flag_->store(true, std::memory_order_relaxed); }
+
+        bool cancelled() const { return flag_->load(std::memory_order_relaxed); }
+
+        bool operator==(const CancelToken &) const = default;
+
+    private:
+        std::shared_ptr<std::atomic<bool> > flag_;
+    };
+
+    struct CancelStats {
+        std::uint64_t cancelled = 0, running = 0; // running: noticed partway through
+        std::uint64_t saved_us = 0, wasted_us = 0; // saved: estimated from the jobs that ran to the end
+
+        CancelStats &operator+=(const CancelStats &other) {
+            cancelled += other.cancelled;
+            running += other.running;
+            saved_us += other.saved_us;
+            wasted_us += other.wasted_us;
+            return *this;
+        }
+    };
+
+    // what cancelling one kind of job saved: a job given up after ranUs would have taken as long as the average
+    // finished one, so the rest of that is saved and ranUs wasted
+    class CancelLedger {
+    public:
+        void finished(std::uint64_t ranUs) {
+            finished_ += 1;
+            finished_us_ += ranUs;
+        }
+
+        void cancelled(std::uint64_t ranUs, bool started) {
+            std::uint64_t finished = finished_.load();
+            std::uint64_t average = finished ? finished_us_.load() / finished : 0;
+            cancelled_ += 1;
+            if (started) running_ += 1;
+            saved_us_ += average > ranUs ? average - ranUs : 0;
+            wasted_us_ += ranUs;
+        }
+
+        CancelStats stats() const { return {cancelled_.load(), running_.load(), saved_us_.load(), wasted_us_.load()}; }
+
+    private:
+        std::atomic<std::uint64_t> finished_{0}, finished_us_{0};
+        std::atomic<std::uint64_t> cancelled_{0}, running_{0}, saved_us_{0}, wasted_us_{0};
+    };
+
+    class JobSystem;
+
+    namespace detail {
+        struct JobStateBase {
+            JobSystem *system;
+            std::mutex mutex;
+            std::condition_variable finished;
+            bool done = false;
+            std::exception_ptr error;
+            std::vector<std::move_only_function<void()> > continuations;
+
+            explicit JobStateBase(JobSystem *jobSystem) : system{jobSystem} {
+            }
+
+            // runs f once the job finished, right away if it already has
+            void onDone(std::move_only_function<void()> f) {
+                {
+                    std::lock_guard lock(mutex);
+                    if (!done) {
+                        continuations.emplace_back(std::move(f));
+                        return;
+                    }
+                }
+                f();
+            }
+
+            void finish() {
+                std::vector<std::move_only_function<void()> > ready;
+                {
+                    std::lock_guard lock(mutex);
+                    done = true;
+                    ready.swap(continuations);
+                }
+                finished.notify_all();
+                for (auto &f: ready) f();
+            }
+        };
+
+        template<typename F, typename T>
+        struct ContinuationResult {
+            using type = std::invoke_result_t<F &, T>;
+        };
+
+        template<typename F>
+        struct ContinuationResult<F, void> {
+            using type = std::invoke_result_t<F &>;
+        };
+
+        template<typename T>
+        using JobResult = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+        template<typename T>
+        struct JobState : JobStateBase {
+            std::optional<JobResult<T> > result;
+
+            using JobStateBase::JobStateBase;
+
+            template<typename F>
+            void run(F &f) {
+                try {
+                    if constexpr (std::is_void_v<T>) {
+                        f();
+                        result.emplace();
+                    } else result.emplace(f());
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                finish();
+            }
+        };
+    }
+
+    // the result of a submitted job, taken once by get() or handed on by then()
+    template<typename T>
+    class JobHandle {
+    public:
+        JobHandle() = default;
+
+        bool valid() const { return state_ != nullptr; }
+
+        bool ready() const {
+            std::lock_guard lock(state_->mutex);
+            return state_->done;
+        }
+
+        // blocks until the job ran, running queued jobs meanwhile instead of idling
+        void wait() const;
+
+        // waits, then returns the job's result or rethrows what it threw
+        T get() {
+            wait();
+            if (state_->error) std::rethrow_exception(state_->error);
+            if constexpr (!std::is_void_v<T>) return std::move(*state_->result);
+        }
+
+        // queues f(result) as a job of its own once this one finished; a throw skips f and carries on to the
+        // returned handle
+        template<typename F>
+        auto then(F &&f, JobPriority priority = JobPriority::Normal);
+
+    private:
+        friend class JobSystem;
+
+        template<typename>
+        friend class JobHandle;
+
+        std::shared_ptr<detail::JobState<T> > state_;
+
+        explicit JobHandle(std::shared_ptr<detail::JobState<T> > state) : state_{std::move(state)} {
+        }
+    };
+
+    // fixed pool of workers, each with a deque per priority: a worker takes its newest job of the highest
+    // priority that has any, from its own deques first, and otherwise steals the oldest from another worker.
+    // jobs submitted from outside the pool are dealt round-robin. threads waiting on a handle run queued jobs
+    class JobSystem {
+    public:
+        using Job = std::move_only_function<void()>;
+
+        explicit JobSystem(unsigned workerCount = defaultWorkerCount());
+
+        // runs whatever is still queued, then joins
+        ~JobSystem();
+
+        JobSystem(const JobSystem &) = delete;
+
+        JobSystem &operator=(const JobSystem &) = delete;
+
+        template<typename F>
+        auto submit(F &&f, JobPriority priority = JobPriority::Normal) {
+            using T = std::invoke_result_t<std::decay_t<F> &>;
+            auto state = std::make_shared<detail::JobState<T> >(this);
+            push([state, f = std::forward<F>(f)]() mutable { state->run(f); }, priority);
+            return JobHandle<T>(std::move(state));
+        }
+
+        // a core per worker, bar the one of the thread that waits on their handles
+        static unsigned defaultWorkerCount() {
+            unsigned cores = std::thread::hardware_concurrency();
+            return cores > 1 ? cores - 1 : 1;
+        }
+
+        std::size_t workerCount() const { return workers_.size(); }
+
+        std::size_t queued() const { return queued_.load(); }
+
+        JobSystemStats stats() const;
+
+        // blocks until state is done, running queued jobs while there are any
+        void wait(detail::JobStateBase &state);
+
+    private:
+        struct Worker {
+            std::mutex mutex;
+            std::array<std::deque<Job>, JOB_PRIORITIES_COUNT> queues;
+            std::atomic<std::uint64_t> jobs{0}, stolen{0}, busy_us{0};
+            std::thread thread;
+        };
+
+        std::vector<std::unique_ptr<Worker> > workers_;
+        std::atomic<std::size_t> queued_{0};
+        std::atomic<std::size_t> next_worker_{0};
+        std::atomic<std::uint64_t> helped_{0};
+        std::chrono::steady_clock::time_point started_ = std::chrono::steady_clock::now();
+
+        std::mutex sleep_mutex_;
+        std::condition_variable wake_;
+        bool stopping_ = false;
+
+        void push(Job job, JobPriority priority);
+
+        // the next job for worker self, or for a thread outside the pool with self -1
+        std::optional<Job> take(int self);
+
+        // runs one queued job, false when there was none
+        bool runOne();
+
+        void workerLoop(int self);
+    };
+
+    template<typename T>
+    void JobHandle<T>::wait() const {
+        state_->system->wait(*state_);
+    }
+
+    template<typename T>
+    template<typename F>
+    auto JobHandle<T>::then(F &&f, JobPriority priority) {
+        using R = typename detail::ContinuationResult<std::decay_t<F>, T>::type;
+
+        auto next = std::make_shared<detail::JobState<R> >(state_->system);
+        state_->onDone([state = state_, next, f = std::forward<F>(f), priority]() mutable {
+            if (state->error) {
+                next->error = state->error;
+                next->finish();
+                return;
+            }
+            state->system->submit([state, next, f = std::move(f)]() mutable {
+                auto call = [&] {
+                    if constexpr (std::is_void_v<T>) return f();
+                    else return f(std::move(*state->result));
+                };
+                next->run(call);
+            }, priority);
+        });
+        return JobHandle<R>(std::move(next));
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace mc::core {
+    // items waiting for a worker, handed out lowest score first at the time one asks: the owner re-scores them as
+    // its priorities change, so what was queued first need not run first. pair it with a job per item that pops
+    // whatever is best by then
+    template<typename T>
+    class WorkQueue {
+    public:
+        void push(T item, float score) {
+            std::lock_guard lock(mutex_);
+            items_.emplace_back(score, std::move(item));
+            sorted_ = false;
+        }
+
+        // score(const T &) -> float for every waiting item
+        template<typename ScoreFn>
+        void rescore(ScoreFn score) {
+            std::lock_guard lock(mutex_);
+            for (auto &[item_score, item]: items_) item_score = score(item);
+            sorted_ = false;
+        }
+
+        // moves every waiting item matching predicate into sink(T)
+        template<typename Predicate, typename Sink>
+        void extractIf(Predicate predicate, Sink sink) {
+            std::lock_guard lock(mutex_);
+            auto kept = std::ranges::partition(items_, [&](const auto &entry) { return !predicate(entry.second); });
+            for (auto &entry: kept) sink(std::move(entry.second));
+            items_.erase(kept.begin(), kept.end());
+        }
+
+        std::optional<T> pop() {
+            std::lock_guard lock(mutex_);
+            if (items_.empty()) return std::nullopt;
+            // sorted highest first, so the best is taken off the back
+            if (!sorted_) {
+                std::ranges::sort(items_, std::ranges::greater{}, &std::pair<float, T>::first);
+                sorted_ = true;
+            }
+            T item = std::move(items_.back().second);
+            items_.pop_back();
+            return item;
+        }
+
+        std::size_t size() const {
+            std::lock_guard lock(mutex_);
+            return items_.size();
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        std::vector<std::pair<float, T> > items_;
+        bool sorted_ = true;
+    };
+}
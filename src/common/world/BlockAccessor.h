@@ -0,0 +1,95 @@
+#pragma once
+#include <glm/vec3.hpp>
+
+#include "Chunk.h"
+#include "ChunkColumn.h"
+#include "Direction.h"
+#include "World.h"
+
+namespace mc::world {
+    // cursor over world blocks caching the current column/chunk; moves between neighbours through
+    // ChunkColumn::neighbors() so spatially coherent walks cost an array index per voxel
+    class BlockAccessor {
+    public:
+        explicit BlockAccessor(const World &world) : world_{world} {
+        }
+
+        BlockAccessor(const World &world, const glm::ivec3 &worldCoord) : world_{world} {
+            moveTo(worldCoord);
+        }
+
+        Block get(const glm::ivec3 &worldCoord) {
+            moveTo(worldCoord);
+            return block();
+        }
+
+        Block step(Direction direction) {
+            glm::ivec3 offset = directionToNormalOffset(direction);
+            position_ += offset;
+            local_coord_ += offset;
+            if (Chunk::inBounds(local_coord_)) return block();
+
+            local_coord_ &= CHUNK_MASK;
+            switch (direction) {
+                case Direction::PositiveY: setChunkIndex(index_ + 1);
+                    break;
+                case Direction::NegativeY: setChunkIndex(index_ - 1);
+                    break;
+                default: {
+                    column_coord_ += horizontalDirectionToNormalOffset(direction);
+                    column_ = column_
+                                  ? column_->neighbors()[horizontalDirectionToIndex(direction)]
+                                  : world_.findColumn(column_coord_);
+                    setChunkIndex(index_);
+                }
+            }
+            return block();
+        }
+
+        Block block() const { return chunk_ ? chunk_->blockAt(local_coord_) : Block{}; }
+
+        bool isOpaque() const { return chunk_ && chunk_->isOpaque(local_coord_); }
+
+        bool isOccluding() const { return chunk_ && chunk_->isOccluding(local_coord_); }
+
+        const glm::ivec3 &position() const { return position_; }
+
+        ChunkColumn *column() const { return column_; }
+        Chunk *chunk() const { return chunk_; }
+
+        ChunkLookup lookup() const {
+            bool in_column = index_ >= 0 && index_ < CHUNKS_PER_COLUMN;
+            return {column_, chunk_, in_column ? index_ : -1, in_column ? local_coord_ : glm::ivec3{}};
+        }
+
+    private:
+        const World &world_;
+
+        glm::ivec3 position_{};
+        glm::ivec3 local_coord_{};
+        glm::ivec2 column_coord_{};
+        int index_ = -1;
+        bool column_cached_ = false;
+
+        ChunkColumn *column_ = nullptr;
+        Chunk *chunk_ = nullptr;
+
+        void moveTo(const glm::ivec3 &worldCoord) {
+            position_ = worldCoord;
+            local_coord_ = worldCoord & CHUNK_MASK;
+
+            glm::ivec2 column_coord = World::worldToColumn(worldCoord);
+            if (!column_cached_ || column_coord != column_coord_) {
+                column_coord_ = column_coord;
+                column_ = world_.findColumn(column_coord);
+                column_cached_ = true;
+            }
+            setChunkIndex(worldCoord.y >> CHUNK_BITS);
+        }
+
+        void setChunkIndex(int index) {
+            index_ = index;
+            chunk_ = column_ && index >= 0 && index < CHUNKS_PER_COLUMN ? column_->chunks()[index].get() : nullptr;
+        }
+    };
+}
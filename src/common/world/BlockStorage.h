@@ -0,0 +1,263 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "Block.h"
+#include "WorldConstants.h"
+#include "core/CopyOnWrite.h"
+
+namespace mc::world {
+    constexpr int CHUNK_VOLUME = CHUNK_XYZ * CHUNK_XYZ * CHUNK_XYZ;
+
+    // plain one-byte-per-voxel layout, kept for comparison against the palette layout
+    class FlatBlockStorage {
+    public:
+        FlatBlockStorage() = default;
+
+        explicit FlatBlockStorage(BlockId fill) {
+            blocks_.fill(Block{fill});
+        }
+
+        BlockId get(std::size_t index) const { return blocks_[index].id; }
+
+        void set(std::size_t index, BlockId blockId) { blocks_[index].id = blockId; }
+
+        void assign(std::span<const BlockId, CHUNK_VOLUME> blocks) {
+            for (std::size_t i = 0; i < CHUNK_VOLUME; ++i) blocks_[i].id = blocks[i];
+        }
+
+        void copyTo(std::span<BlockId, CHUNK_VOLUME> out) const {
+            for (std::size_t i = 0; i < CHUNK_VOLUME; ++i) out[i] = blocks_[i].id;
+        }
+
+        void clear() { blocks_.fill(Block{}); }
+
+        bool isUniform() const {
+            return std::ranges::all_of(blocks_, [&](const Block &block) { return block.id == blocks_[0].id; });
+        }
+
+        BlockId uniformBlock() const { return blocks_[0].id; }
+
+        std::size_t memoryUsage() const { return sizeof(blocks_); }
+
+    private:
+        std::array<Block, CHUNK_VOLUME> blocks_{};
+    };
+
+    // per-chunk palette of BlockIds + bit-packed palette indices (0/1/2/4/8 bits per voxel);
+    // the payload is copy-on-write, uniform payloads are shared immutable instances per BlockId
+    class PaletteBlockStorage {
+    public:
+        PaletteBlockStorage() : PaletteBlockStorage(BlockId::Air) {
+        }
+
+        explicit PaletteBlockStorage(BlockId fill) : data_(uniformPayload(fill)) {
+        }
+
+        BlockId get(std::size_t index) const {
+            const Payload &data = *data_;
+            if (data.bits == 0) return data.palette[0];
+            std::uint64_t word = data.words[index >> data.per_word_shift];
+            unsigned shift = static_cast<unsigned>(index & data.per_word_mask) * data.bits;
+            return data.palette[(word >> shift) & data.value_mask];
+        }
+
+        void set(std::size_t index, BlockId blockId) {
+            if (data_->bits == 0 && data_->palette[0] == blockId) return; // keep sharing the uniform payload
+            if (!core::soleOwner(data_)) data_ = std::make_shared<Payload>(*data_); // copy on first write
+
+            Payload &data = *data_;
+            std::uint8_t entry = data.lookup[static_cast<std::uint8_t>(blockId)];
+            if (entry == NO_ENTRY) {
+                entry = data.addToPalette(blockId);
+                if (data.palette_size > (1u << data.bits)) data.resize(bitsFor(data.palette_size));
+            }
+            if (data.bits == 0) return; // single entry palette, nothing to store
+
+            std::uint64_t &word = data.words[index >> data.per_word_shift];
+            unsigned shift = static_cast<unsigned>(index & data.per_word_mask) * data.bits;
+            word = (word & ~(data.value_mask << shift)) | (static_cast<std::uint64_t>(entry) << shift);
+        }
+
+        // replaces every voxel at once, packing the words directly instead of growing the palette per set
+        void assign(std::span<const BlockId, CHUNK_VOLUME> blocks) {
+            std::array<std::uint8_t, NUM_BLOCKS> lookup;
+            lookup.fill(NO_ENTRY);
+            std::array<BlockId, NUM_BLOCKS> palette{};
+            int palette_size = 0;
+            for (BlockId id: blocks) {
+                std::uint8_t &entry = lookup[static_cast<std::uint8_t>(id)];
+                if (entry == NO_ENTRY) {
+                    entry = static_cast<std::uint8_t>(palette_size);
+                    palette[palette_size++] = id;
+                }
+            }
+            if (palette_size == 1) {
+                data_ = uniformPayload(palette[0]);
+                return;
+            }
+
+            if (!core::soleOwner(data_)) data_ = std::make_shared<Payload>(palette[0]);
+            Payload &data = *data_;
+            data.palette = palette;
+            data.lookup = lookup;
+            data.palette_size = static_cast<std::uint8_t>(palette_size);
+            data.bits = 0;
+            data.resize(bitsFor(palette_size));
+
+            switch (data.bits) {
+                case 1: packWords<1>(blocks, lookup, data.words);
+                    break;
+                case 2: packWords<2>(blocks, lookup, data.words);
+                    break;
+                case 4: packWords<4>(blocks, lookup, data.words);
+                    break;
+                default: packWords<8>(blocks, lookup, data.words);
+            }
+        }
+
+        void copyTo(std::span<BlockId, CHUNK_VOLUME> out) const {
+            const Payload &data = *data_;
+            if (data.bits == 0) {
+                std::ranges::fill(out, data.palette[0]);
+                return;
+            }
+            switch (data.bits) {
+                case 1: unpackWords<1>(data, out);
+                    break;
+                case 2: unpackWords<2>(data, out);
+                    break;
+                case 4: unpackWords<4>(data, out);
+                    break;
+                default: unpackWords<8>(data, out);
+            }
+        }
+
+        // back to all air, keeping an exclusively owned payload and its word buffer for reuse
+        void clear() {
+            if (!core::soleOwner(data_)) {
+                data_ = uniformPayload(BlockId::Air);
+                return;
+            }
+            Payload &data = *data_;
+            data.lookup.fill(NO_ENTRY);
+            data.palette_size = 0;
+            data.addToPalette(BlockId::Air);
+            data.words.clear();
+            data.bits = 0;
+        }
+
+        bool isUniform() const { return data_->bits == 0; }
+        BlockId uniformBlock() const { return data_->palette[0]; }
+
+        int bits() const { return data_->bits; }
+        int paletteSize() const { return data_->palette_size; }
+
+        std::size_t memoryUsage() const {
+            if (data_ == uniformPayload(data_->palette[0])) return sizeof(*this); // shared instance
+            return sizeof(*this) + sizeof(Payload) + data_->words.capacity() * sizeof(std::uint64_t);
+        }
+
+    private:
+        static constexpr std::uint8_t NO_ENTRY = 0xFF;
+        static constexpr int WORD_BITS = 64;
+
+        struct Payload {
+            std::array<BlockId, NUM_BLOCKS> palette{};
+            std::array<std::uint8_t, NUM_BLOCKS> lookup{}; // BlockId -> palette index
+            std::uint8_t palette_size = 0;
+
+            std::vector<std::uint64_t> words;
+            std::uint8_t bits = 0;
+            std::uint8_t per_word_shift = 0; // log2(values per word)
+            std::uint64_t per_word_mask = 0;
+            std::uint64_t value_mask = 0;
+
+            explicit Payload(BlockId fill) {
+                lookup.fill(NO_ENTRY);
+                addToPalette(fill);
+            }
+
+            std::uint8_t addToPalette(BlockId blockId) {
+                assert(palette_size < NUM_BLOCKS);
+                palette[palette_size] = blockId;
+                lookup[static_cast<std::uint8_t>(blockId)] = palette_size;
+                return palette_size++;
+            }
+
+            void resize(int newBits) {
+                int old_bits = bits;
+                std::uint8_t old_shift = per_word_shift;
+                std::uint64_t old_word_mask = per_word_mask;
+                std::uint64_t old_value_mask = value_mask;
+
+                bits = static_cast<std::uint8_t>(newBits);
+                per_word_shift = static_cast<std::uint8_t>(std::countr_zero(static_cast<unsigned>(WORD_BITS / newBits)));
+                per_word_mask = (1ull << per_word_shift) - 1;
+                value_mask = (1ull << newBits) - 1;
+
+                if (old_bits == 0) { // every voxel was palette entry 0, reuse the word buffer as is
+                    words.assign(CHUNK_VOLUME >> per_word_shift, 0);
+                    return;
+                }
+
+                std::vector<std::uint64_t> old_words = std::move(words);
+                words.assign(CHUNK_VOLUME >> per_word_shift, 0);
+                for (std::size_t i = 0; i < CHUNK_VOLUME; ++i) {
+                    std::uint64_t entry = (old_words[i >> old_shift] >> ((i & old_word_mask) * old_bits)) & old_value_mask;
+                    words[i >> per_word_shift] |= entry << ((i & per_word_mask) * bits);
+                }
+            }
+        };
+
+        std::shared_ptr<Payload> data_;
+
+        // fixed-width loops so the compiler can unroll/vectorize the bulk paths
+        template<int BITS>
+        static void packWords(std::span<const BlockId, CHUNK_VOLUME> blocks,
+                              const std::array<std::uint8_t, NUM_BLOCKS> &lookup,
+                              std::vector<std::uint64_t> &words) {
+            constexpr int PER_WORD = WORD_BITS / BITS;
+            for (std::size_t w = 0; w < words.size(); ++w) {
+                std::uint64_t word = 0;
+                for (int i = 0; i < PER_WORD; ++i)
+                    word |= static_cast<std::uint64_t>(lookup[static_cast<std::uint8_t>(blocks[w * PER_WORD + i])])
+                            << (i * BITS);
+                words[w] = word;
+            }
+        }
+
+        template<int BITS>
+        static void unpackWords(const Payload &data, std::span<BlockId, CHUNK_VOLUME> out) {
+            constexpr int PER_WORD = WORD_BITS / BITS;
+            constexpr std::uint64_t MASK = (1ull << BITS) - 1;
+            for (std::size_t w = 0; w < data.words.size(); ++w) {
+                std::uint64_t word = data.words[w];
+                for (int i = 0; i < PER_WORD; ++i)
+                    out[w * PER_WORD + i] = data.palette[(word >> (i * BITS)) & MASK];
+            }
+        }
+
+        static int bitsFor(int paletteSize) {
+            if (paletteSize <= 1) return 0;
+            int needed = std::bit_width(static_cast<unsigned>(paletteSize - 1));
+            return static_cast<int>(std::bit_ceil(static_cast<unsigned>(needed))); // 1, 2, 4, 8
+        }
+
+        static const std::shared_ptr<Payload> &uniformPayload(BlockId blockId) {
+            static const std::array<std::shared_ptr<Payload>, NUM_BLOCKS> payloads = [] {
+                std::array<std::shared_ptr<Payload>, NUM_BLOCKS> out;
+                for (std::size_t i = 0; i < NUM_BLOCKS; ++i)
+                    out[i] = std::make_shared<Payload>(static_cast<BlockId>(i));
+                return out;
+            }();
+            return payloads[static_cast<std::uint8_t>(blockId)];
+        }
+    };
+}
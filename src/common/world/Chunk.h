@@ -1,14 +1,18 @@
 #pragma once
 #include <array>
+#include <atomic>
+#include <bit>
 #include <cassert>
+#include <span>
 #include <glm/vec3.hpp>
 
 #include "Block.h"
+#include "BlockStorage.h"
 #include "Direction.h"
+#include "OccupancyMasks.h"
 #include "WorldConstants.h"
 
 namespace mc::world {
-    constexpr int CHUNK_VOLUME = CHUNK_XYZ * CHUNK_XYZ * CHUNK_XYZ;
     constexpr auto CHUNK_SIZE_VEC = glm::ivec3(CHUNK_XYZ);
     constexpr int CHUNK_SLICE_VOLUME = CHUNK_XYZ * CHUNK_XYZ; // 256
     constexpr int LAST = CHUNK_XYZ - 1; // 15
@@ -22,33 +26,103 @@ namespace mc::world {
         }
     };
 
-    using SideFace = std::array<Block, CHUNK_XYZ * CHUNK_XYZ>;
-    using NeighborSideFaces = std::array<SideFace, DIRECTIONS_COUNT>;
+    // FlatBlockStorage trades 4-8x resident memory for a branch-free blockAt; the MC_FLAT_BLOCK_STORAGE cmake option
+    // selects it
+#ifdef MC_FLAT_BLOCK_STORAGE
+    using ChunkBlockStorage = FlatBlockStorage;
+#else
+    using ChunkBlockStorage = PaletteBlockStorage;
+#endif
+
+    class Chunk;
+    using AdjacentChunks = std::array<const Chunk *, DIRECTIONS_COUNT>;
 
     class Chunk {
     public:
-        explicit Chunk(const glm::ivec3 &coord) : coord_(coord) {
+        explicit Chunk(const glm::ivec3 &coord) : coord_(coord), version_(nextEpoch()) {
+        }
+
+        // uniform chunk sharing the immutable payload for fill until the first differing setBlock
+        Chunk(const glm::ivec3 &coord, BlockId fill)
+            : blocks_(fill), occupancy_(fill), coord_(coord), non_air_blocks_(Block{fill}.opaque() ? CHUNK_VOLUME : 0),
+              version_(nextEpoch()) {
         }
 
         ~Chunk() = default;
 
-        const Block &blockAt(const glm::ivec3 &localCoord) const {
+        // recycle as an empty chunk at coord, keeping exclusively owned storage allocated
+        void reset(const glm::ivec3 &coord) {
+            coord_ = coord;
+            blocks_.clear();
+            occupancy_.clear();
+            non_air_blocks_ = 0;
+            version_ = nextEpoch();
+        }
+
+        void reset(const glm::ivec3 &coord, BlockId fill) {
+            *this = Chunk(coord, fill);
+        }
+
+        Block blockAt(const glm::ivec3 &localCoord) const {
             assert(inBounds(localCoord));
-            return blocks_[index(localCoord)];
+            return Block{blocks_.get(index(localCoord))};
         }
 
         void setBlock(const glm::ivec3 &localCoord, BlockId blockId) {
             assert(inBounds(localCoord));
-            Block &cell = blocks_[index(localCoord)];
+            std::size_t i = index(localCoord);
+            Block cell{blocks_.get(i)};
             if (cell.id == blockId) return; // no change
 
             if (cell.opaque()) --non_air_blocks_;
             cell = Block{blockId};
+            blocks_.set(i, blockId);
+            occupancy_.set(localCoord, cell);
             if (cell.opaque()) ++non_air_blocks_;
+            ++version_;
+        }
+
+        // bulk replacement of every voxel, ids in (y, z, x) order
+        void assignBlocks(std::span<const BlockId, CHUNK_VOLUME> blocks) {
+            blocks_.assign(blocks);
+            occupancy_.assign(blocks);
+            non_air_blocks_ = 0;
+            for (std::uint32_t row: occupancy_.opaque()) non_air_blocks_ += std::popcount(row);
+            ++version_;
+        }
+
+        // copy pinned at the current version: shares both payloads, so it costs two refcounts and the next write
+        // to this chunk copies the payload instead of mutating it under a reader
+        Chunk snapshot() const { return *this; }
+
+        // low half counts edits, high half is an epoch drawn per construction/reset, so a recycled or reloaded
+        // chunk never repeats a version an older mesh was built from
+        std::uint64_t version() const { return version_; }
+
+        void copyBlocks(std::span<BlockId, CHUNK_VOLUME> out) const { blocks_.copyTo(out); }
+
+        bool isOpaque(const glm::ivec3 &localCoord) const {
+            return (occupancy_.opaqueRow(localCoord.y, localCoord.z) >> localCoord.x) & 1u;
+        }
+
+        bool isOccluding(const glm::ivec3 &localCoord) const {
+            return (occupancy_.occludingRow(localCoord.y, localCoord.z) >> localCoord.x) & 1u;
         }
 
+        const OccupancyMasks &occupancy() const { return occupancy_; }
+
         bool isEmpty() const { return non_air_blocks_ == 0; }
 
+        bool isUniform() const { return blocks_.isUniform(); }
+
+        BlockId uniformBlock() const { return blocks_.uniformBlock(); }
+
+        bool isUniformOccluder() const { return isUniform() && Block{uniformBlock()}.occluding(); }
+
+        std::size_t memoryUsage() const {
+            return sizeof(*this) - sizeof(blocks_) - sizeof(occupancy_) + blocks_.memoryUsage() + occupancy_.memoryUsage();
+        }
+
         static bool inBounds(const glm::ivec3 &localCoord) {
             auto ux = static_cast<std::uint32_t>(localCoord.x);
             auto uy = static_cast<std::uint32_t>(localCoord.y);
@@ -58,79 +132,20 @@ namespace mc::world {
 
         const glm::ivec3 &coord() const { return coord_; }
 
-        NeighborSideFaces collectNeighborSideFaces(const std::array<Chunk *, DIRECTIONS_COUNT> &neighbors) const {
-            NeighborSideFaces faces{};
-
-            for (Direction direction: DIRECTIONS) {
-                uint8_t index = directionToIndex(direction);
-                if (Chunk *neighbor = neighbors[index])
-                    faces[index] = neighbor->retrieveSideFace(oppositeDirection(direction));
-            }
-            return faces;
-        }
-
-        const Block &getNeighborBlock(const NeighborSideFaces &neighborSideFaces,
-                                      const glm::ivec3 &localCoord,
-                                      Direction direction) const {
-            const SideFace &plane = neighborSideFaces[directionToIndex(direction)];
-
-            switch (direction) {
-                case Direction::PositiveX:
-                case Direction::NegativeX: return plane[localCoord.y * CHUNK_XYZ + localCoord.z];
-                case Direction::PositiveY:
-                case Direction::NegativeY: return plane[localCoord.z * CHUNK_XYZ + localCoord.x];
-                case Direction::PositiveZ:
-                case Direction::NegativeZ: return plane[localCoord.y * CHUNK_XYZ + localCoord.x];
-            }
-        }
-
     private:
-        std::array<Block, CHUNK_VOLUME> blocks_{};
+        ChunkBlockStorage blocks_{};
+        OccupancyMasks occupancy_{};
         glm::ivec3 coord_;
         int non_air_blocks_ = 0;
+        std::uint64_t version_;
 
-        std::size_t index(const glm::ivec3 &localCoord) const {
-            return (localCoord.y * CHUNK_XYZ + localCoord.z) * CHUNK_XYZ + localCoord.x;
+        static std::uint64_t nextEpoch() {
+            static std::atomic<std::uint32_t> epoch{0};
+            return static_cast<std::uint64_t>(epoch.fetch_add(1, std::memory_order_relaxed) + 1) << 32;
         }
 
-        SideFace retrieveSideFace(Direction direction) const {
-            SideFace out{};
-
-            switch (direction) {
-                case Direction::PositiveY: {
-                    std::size_t base = LAST * CHUNK_SLICE_VOLUME;
-                    std::copy_n(blocks_.data() + base, CHUNK_SLICE_VOLUME, out.begin());
-                    break;
-                }
-                case Direction::NegativeY: {
-                    std::copy_n(blocks_.data(), CHUNK_SLICE_VOLUME, out.begin());
-                    break;
-                }
-
-                case Direction::PositiveZ:
-                case Direction::NegativeZ: {
-                    int z = direction == Direction::PositiveZ ? LAST : 0;
-                    for (int y = 0; y < CHUNK_XYZ; ++y) {
-                        const Block *src = blocks_.data() + (y * CHUNK_XYZ + z) * CHUNK_XYZ;
-                        std::copy_n(src, CHUNK_XYZ, out.begin() + y * CHUNK_XYZ);
-                    }
-                    break;
-                }
-
-                case Direction::PositiveX:
-                case Direction::NegativeX: {
-                    int x = direction == Direction::PositiveX ? LAST : 0;
-                    const Block *base = blocks_.data() + x;
-                    for (int y = 0; y < CHUNK_XYZ; ++y) {
-                        const Block *row = base + y * CHUNK_SLICE_VOLUME;
-                        for (int z = 0; z < CHUNK_XYZ; ++z)
-                            out[y * CHUNK_XYZ + z] = row[z * CHUNK_XYZ];
-                    }
-                    break;
-                }
-            }
-
-            return out;
+        std::size_t index(const glm::ivec3 &localCoord) const {
+            return (localCoord.y * CHUNK_XYZ + localCoord.z) * CHUNK_XYZ + localCoord.x;
         }
     };
 }
@@ -1,6 +1,8 @@
-#include <functional>
+#include <algorithm>
 
 #include "ChunkColumn.h"
+#include "ChunkColumnPool.h"
+#include "DensityField.h"
 
 using namespace mc::world;
 
@@ -15,9 +17,105 @@ void ChunkColumn::linkNeighbor(Direction direction, ChunkColumn &other) {
 }
 
 void ChunkColumn::reset(const glm::ivec2 &newCoord) {
+    unlinkNeighbors();
     coord_ = newCoord;
     for (auto &chunk: chunks_) chunk.reset();
-    neighbors_.fill(nullptr);
+    loaded_mask_ = 0;
+    stage_ = GenerationStage::Empty;
+    has_heightmap_ = false;
+}
+
+void ChunkColumn::unlinkNeighbors() {
+    for (Direction direction: HORIZONTAL_DIRECTIONS) {
+        ChunkColumn *&neighbor = neighbors_[horizontalDirectionToIndex(direction)];
+        if (!neighbor) continue;
+
+        ChunkColumn *&back_link = neighbor->neighbors_[horizontalDirectionToIndex(oppositeDirection(direction))];
+        if (back_link == this) back_link = nullptr;
+        neighbor = nullptr;
+    }
+}
+
+void ChunkColumn::unloadChunks(ChunkMask mask, ChunkColumnPool &pool) {
+    mask &= loaded_mask_;
+    for (int i = 0; i < CHUNKS_PER_COLUMN; ++i)
+        if ((mask >> i) & 1u) pool.release(std::move(chunks_[i]));
+    loaded_mask_ &= ~mask;
+}
+
+void ChunkColumn::adoptChunks(ChunkColumn &other, ChunkMask mask) {
+    mask &= other.loaded_mask_;
+    for (int i = 0; i < CHUNKS_PER_COLUMN; ++i)
+        if ((mask >> i) & 1u) chunks_[i] = std::move(other.chunks_[i]);
+    other.loaded_mask_ &= ~mask;
+    loaded_mask_ |= mask;
+}
+
+void ChunkColumn::fillTerrain(ChunkColumnPool &pool, ChunkMask mask) {
+    auto [min_it, max_it] = std::ranges::minmax_element(heightmap_);
+    int min_height = *min_it, max_height = *max_it;
+    std::array<BlockId, CHUNK_VOLUME> blocks;
+
+    for (int i = 0; i < CHUNKS_PER_COLUMN; ++i) {
+        if (!((mask >> i) & 1u)) continue;
+        loaded_mask_ |= 1u << i;
+        glm::ivec3 chunk_coord(coord_.x, i, coord_.y);
+        int slice_min_Y = i * CHUNK_XYZ;
+
+        // above the surface everywhere: air, nothing to store
+        if (slice_min_Y > max_height) continue;
+
+        // buried below the dirt layer everywhere: share the uniform stone instance
+        if (i > 0 && slice_min_Y + LAST < min_height - 3) {
+            chunks_[i] = pool.acquireChunk(chunk_coord, BlockId::Stone);
+            continue;
+        }
+
+        // a y layer is a contiguous CHUNK_SLICE_VOLUME run laid out like the heightmap, so layers entirely
+        // below or above the surface band are single fills and the rest a branch-light pass over the heightmap
+        for (int y = 0; y < CHUNK_XYZ; ++y) {
+            int wy = slice_min_Y + y;
+            auto layer = blocks.begin() + y * CHUNK_SLICE_VOLUME;
+
+            if (wy > max_height) {
+                std::fill(layer, blocks.end(), BlockId::Air);
+                break;
+            }
+            if (wy == 0) std::fill_n(layer, CHUNK_SLICE_VOLUME, BlockId::Bedrock);
+            else if (wy < min_height - 3) std::fill_n(layer, CHUNK_SLICE_VOLUME, BlockId::Stone);
+            else
+                for (int c = 0; c < CHUNK_SLICE_VOLUME; ++c) {
+                    int h = heightmap_[c];
+                    layer[c] = wy > h ? BlockId::Air
+                                      : wy == h ? BlockId::Grass
+                                                : wy >= h - 3 ? BlockId::Dirt
+                                                              : BlockId::Stone;
+                }
+        }
+
+        auto chunk = pool.acquireChunk(chunk_coord);
+        chunk->assignBlocks(blocks);
+        chunks_[i] = std::move(chunk);
+    }
+}
+
+void ChunkColumn::generateDensityTerrain(const DensityField &field, ChunkColumnPool &pool, ChunkMask mask) {
+    std::array<BlockId, CHUNK_VOLUME> blocks;
+
+    for (int i = 0; i < CHUNKS_PER_COLUMN; ++i) {
+        if (!((mask >> i) & 1u)) continue;
+        loaded_mask_ |= 1u << i;
+        glm::ivec3 chunk_coord(coord_.x, i, coord_.y);
+
+        if (std::optional<BlockId> fill = field.fillChunk(chunk_coord, blocks)) {
+            if (*fill != BlockId::Air) chunks_[i] = pool.acquireChunk(chunk_coord, *fill);
+            continue;
+        }
+
+        auto chunk = pool.acquireChunk(chunk_coord);
+        chunk->assignBlocks(blocks);
+        chunks_[i] = std::move(chunk);
+    }
 }
 
 std::pair<Chunk *, const ChunkColumn *> ChunkColumn::adjacentChunkAndColumn(Direction direction, int index) const {
@@ -35,8 +133,8 @@ std::pair<Chunk *, const ChunkColumn *> ChunkColumn::adjacentChunkAndColumn(Dire
     return {nullptr, nullptr};
 }
 
-std::array<Chunk *, DIRECTIONS_COUNT> ChunkColumn::adjacentChunks(int index) const {
-    std::array<Chunk *, DIRECTIONS_COUNT> adjacent_chunks{};
+AdjacentChunks ChunkColumn::adjacentChunks(int index) const {
+    AdjacentChunks adjacent_chunks{};
 
     for (Direction direction: HORIZONTAL_DIRECTIONS)
         if (ChunkColumn *neighbor = neighbors_[horizontalDirectionToIndex(direction)])
@@ -48,3 +146,10 @@ std::array<Chunk *, DIRECTIONS_COUNT> ChunkColumn::adjacentChunks(int index) con
                                                                   : nullptr;
     return adjacent_chunks;
 }
+
+std::size_t ChunkColumn::memoryUsage() const {
+    std::size_t bytes = sizeof(*this);
+    for (const auto &chunk: chunks_)
+        if (chunk) bytes += chunk->memoryUsage();
+    return bytes;
+}
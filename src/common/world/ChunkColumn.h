@@ -1,7 +1,10 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <memory>
-#include <functional>
+#include <span>
+#include <type_traits>
 #include <glm/vec2.hpp>
 
 #include "Chunk.h"
@@ -9,6 +12,17 @@
 #include "WorldConstants.h"
 
 namespace mc::world {
+    class ChunkColumnPool;
+    class DensityField;
+
+    // a column advances through these in order; meshing waits for Ready
+    enum class GenerationStage : std::uint8_t {
+        Empty,
+        Terrain, // generated or loaded blocks, surface layers included
+        Decorated, // features drawn into the generated chunks, then the journaled edits replayed over all of them
+        Ready // Decorated along with its horizontal neighbours, whose border blocks its meshes read
+    };
+
     class ChunkColumn {
     public:
         explicit ChunkColumn(const glm::ivec2 &coord) : coord_(coord) {
@@ -22,50 +36,69 @@ namespace mc::world {
 
         void reset(const glm::ivec2 &newCoord);
 
+        void unlinkNeighbors();
+
         std::pair<Chunk *, const ChunkColumn *> adjacentChunkAndColumn(Direction direction, int index) const;
 
-        std::array<Chunk *, DIRECTIONS_COUNT> adjacentChunks(int index) const;
+        AdjacentChunks adjacentChunks(int index) const;
 
         const auto &neighbors() const { return neighbors_; }
 
+        std::size_t memoryUsage() const;
+
         auto &chunks() { return chunks_; }
         const auto &chunks() const { return chunks_; }
 
-        void generateTerrain(const std::function<int(int, int)> &heightFn) {
-            for (int i = 0; i < CHUNKS_PER_COLUMN; ++i) {
-                glm::ivec3 chunk_coord(coord_.x, i, coord_.y);
-                auto chunk = std::make_unique<Chunk>(chunk_coord);
-
-                int slice_min_Y = chunk_coord.y * CHUNK_XYZ;
-                int slice_max_Y = slice_min_Y + CHUNK_XYZ - 1;
-
-                for (int z = 0; z < CHUNK_XYZ; ++z)
-                    for (int x = 0; x < CHUNK_XYZ; ++x) {
-                        int wx = coord_.x * CHUNK_XYZ + x;
-                        int wz = coord_.y * CHUNK_XYZ + z;
-                        int h = heightFn(wx, wz);
-
-                        if (h < slice_min_Y) continue;
-
-                        int top = std::min(h, slice_max_Y) - slice_min_Y;
-                        for (int y = 0; y <= top; ++y) {
-                            int wy = slice_min_Y + y;
-                            BlockId id = wy == h ? BlockId::Grass : wy >= h - 3 ? BlockId::Dirt : BlockId::Stone;
-                            chunk->setBlock({x, y, z}, id);
-                        }
-
-                        if (i == 0) chunk->setBlock({x, 0, z}, BlockId::Bedrock);
-                    }
-
-                if (chunk->isEmpty()) continue;
-                chunks_[i] = std::move(chunk);
+        // sparse vertical index: a loaded index with no chunk is air, an unloaded one is simply not resident
+        ChunkMask loadedMask() const { return loaded_mask_; }
+        bool isLoaded(int index) const { return (loaded_mask_ >> index) & 1u; }
+        void markLoaded(ChunkMask mask) { loaded_mask_ |= mask; }
+
+        void unloadChunks(ChunkMask mask, ChunkColumnPool &pool);
+
+        // moves the chunks of mask, loaded in other (a detached column at the same coord), into this one
+        void adoptChunks(ChunkColumn &other, ChunkMask mask);
+
+        GenerationStage stage() const { return stage_; }
+        void advanceStage(GenerationStage stage) { stage_ = std::max(stage_, stage); }
+
+        bool hasHeightmap() const { return has_heightmap_; }
+        int surfaceHeight(int x, int z) const { return heightmap_[z * CHUNK_XYZ + x]; }
+
+        // generates the chunks in mask; heightFn is inlined into one pass over the column's heightmap, which is
+        // kept for later vertical loads. it either samples, int(int wx, int wz), or fills a heightmap row at once,
+        // void(int wx0, int wz, std::span<std::int16_t, CHUNK_XYZ>), for generators that batch a row
+        template<typename HeightFn>
+        void generateTerrain(HeightFn &&heightFn, ChunkColumnPool &pool, ChunkMask mask = ALL_CHUNKS) {
+            if (!has_heightmap_) {
+                int wx0 = coord_.x * CHUNK_XYZ;
+                for (int z = 0; z < CHUNK_XYZ; ++z) {
+                    int wz = coord_.y * CHUNK_XYZ + z;
+                    std::span<std::int16_t, CHUNK_XYZ> row(heightmap_.data() + z * CHUNK_XYZ, CHUNK_XYZ);
+                    if constexpr (std::is_invocable_v<HeightFn &, int, int>)
+                        for (int x = 0; x < CHUNK_XYZ; ++x) row[x] = static_cast<std::int16_t>(heightFn(wx0 + x, wz));
+                    else heightFn(wx0, wz, row);
+                }
+                has_heightmap_ = true;
             }
+            fillTerrain(pool, mask);
         }
 
+        // generates the chunks in mask from a 3d density field, chunk by chunk; no heightmap is involved
+        void generateDensityTerrain(const DensityField &field, ChunkColumnPool &pool, ChunkMask mask = ALL_CHUNKS);
+
     private:
         glm::ivec2 coord_;
         std::array<std::unique_ptr<Chunk>, CHUNKS_PER_COLUMN> chunks_{};
 
         std::array<ChunkColumn *, HORIZONTAL_DIRECTIONS_COUNT> neighbors_{};
+
+        ChunkMask loaded_mask_ = 0;
+        GenerationStage stage_ = GenerationStage::Empty;
+        std::array<std::int16_t, CHUNK_XYZ * CHUNK_XYZ> heightmap_{};
+        bool has_heightmap_ = false;
+
+        // builds each chunk of mask from the heightmap a y layer at a time and assigns it in bulk
+        void fillTerrain(ChunkColumnPool &pool, ChunkMask mask);
     };
 }
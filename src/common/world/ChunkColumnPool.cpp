@@ -0,0 +1,107 @@
+#include "ChunkColumnPool.h"
+
+using namespace mc::world;
+
+std::unique_ptr<ChunkColumn> ChunkColumnPool::acquireColumn(const glm::ivec2 &coord) {
+    std::unique_ptr<ChunkColumn> column;
+    {
+        std::lock_guard lock(mutex_);
+        if (!columns_.empty()) {
+            column = std::move(columns_.back());
+            columns_.pop_back();
+            stats_.bytes_pooled -= sizeof(ChunkColumn);
+            ++stats_.column_hits;
+        } else ++stats_.column_misses;
+    }
+
+    if (!column) return std::make_unique<ChunkColumn>(coord);
+    column->reset(coord);
+    return column;
+}
+
+std::unique_ptr<Chunk> ChunkColumnPool::acquireChunk(const glm::ivec3 &coord) {
+    std::unique_ptr<Chunk> chunk = popChunk();
+    if (!chunk) return std::make_unique<Chunk>(coord);
+    chunk->reset(coord);
+    return chunk;
+}
+
+std::unique_ptr<Chunk> ChunkColumnPool::acquireChunk(const glm::ivec3 &coord, BlockId fill) {
+    // uniform chunks share their payload, so any pooled object will do
+    std::unique_ptr<Chunk> chunk = popChunk();
+    if (!chunk) return std::make_unique<Chunk>(coord, fill);
+    chunk->reset(coord, fill);
+    return chunk;
+}
+
+std::unique_ptr<Chunk> ChunkColumnPool::popChunk() {
+    std::lock_guard lock(mutex_);
+    if (chunks_.empty()) {
+        ++stats_.chunk_misses;
+        return nullptr;
+    }
+    std::unique_ptr<Chunk> chunk = std::move(chunks_.back());
+    chunks_.pop_back();
+    stats_.bytes_pooled -= chunk->memoryUsage();
+    ++stats_.chunk_hits;
+    return chunk;
+}
+
+void ChunkColumnPool::release(std::unique_ptr<ChunkColumn> column) {
+    if (!column) return;
+
+    column->unlinkNeighbors();
+
+    std::lock_guard lock(mutex_);
+    for (auto &chunk: column->chunks())
+        if (chunk) releaseLocked(std::move(chunk));
+
+    if (columns_.size() < max_columns_) {
+        stats_.bytes_pooled += sizeof(ChunkColumn);
+        columns_.emplace_back(std::move(column));
+    } else ++stats_.dropped;
+}
+
+void ChunkColumnPool::release(std::unique_ptr<Chunk> chunk) {
+    if (!chunk) return;
+
+    std::lock_guard lock(mutex_);
+    releaseLocked(std::move(chunk));
+}
+
+void ChunkColumnPool::releaseLocked(std::unique_ptr<Chunk> chunk) {
+    if (chunks_.size() >= max_chunks_) {
+        ++stats_.dropped;
+        return;
+    }
+    stats_.bytes_pooled += chunk->memoryUsage();
+    chunks_.emplace_back(std::move(chunk));
+}
+
+void ChunkColumnPool::setHighWaterMark(std::size_t maxColumns, std::size_t maxChunks) {
+    std::lock_guard lock(mutex_);
+    max_columns_ = maxColumns;
+    max_chunks_ = maxChunks;
+    trimLocked();
+}
+
+void ChunkColumnPool::trimLocked() {
+    while (columns_.size() > max_columns_) {
+        columns_.pop_back();
+        stats_.bytes_pooled -= sizeof(ChunkColumn);
+        ++stats_.dropped;
+    }
+    while (chunks_.size() > max_chunks_) {
+        stats_.bytes_pooled -= chunks_.back()->memoryUsage();
+        chunks_.pop_back();
+        ++stats_.dropped;
+    }
+}
+
+ChunkPoolStats ChunkColumnPool::stats() const {
+    std::lock_guard lock(mutex_);
+    ChunkPoolStats stats = stats_;
+    stats.pooled_columns = columns_.size();
+    stats.pooled_chunks = chunks_.size();
+    return stats;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Chunk.h"
+#include "ChunkColumn.h"
+
+namespace mc::world {
+    struct ChunkPoolStats {
+        std::uint64_t column_hits = 0, column_misses = 0;
+        std::uint64_t chunk_hits = 0, chunk_misses = 0;
+        std::uint64_t dropped = 0; // released above the high-water mark and freed
+        std::size_t pooled_columns = 0, pooled_chunks = 0;
+        std::size_t bytes_pooled = 0;
+    };
+
+    // free lists of evicted ChunkColumns/Chunks reused by generation; safe to use from generation workers
+    class ChunkColumnPool {
+    public:
+        // steady straight-line movement evicts and creates one ring of 2 * LOAD_RADIUS + 1 columns per step
+        static constexpr std::size_t DEFAULT_MAX_COLUMNS = 4 * (2 * LOAD_RADIUS + 1);
+        static constexpr std::size_t DEFAULT_MAX_CHUNKS = DEFAULT_MAX_COLUMNS * (2 * VERTICAL_LOAD_RADIUS + 1);
+
+        explicit ChunkColumnPool(std::size_t maxColumns = DEFAULT_MAX_COLUMNS,
+                                 std::size_t maxChunks = DEFAULT_MAX_CHUNKS)
+            : max_columns_{maxColumns}, max_chunks_{maxChunks} {
+        }
+
+        std::unique_ptr<ChunkColumn> acquireColumn(const glm::ivec2 &coord);
+
+        std::unique_ptr<Chunk> acquireChunk(const glm::ivec3 &coord);
+
+        std::unique_ptr<Chunk> acquireChunk(const glm::ivec3 &coord, BlockId fill);
+
+        void release(std::unique_ptr<ChunkColumn> column);
+
+        void release(std::unique_ptr<Chunk> chunk);
+
+        void setHighWaterMark(std::size_t maxColumns, std::size_t maxChunks);
+
+        ChunkPoolStats stats() const;
+
+    private:
+        mutable std::mutex mutex_;
+        std::vector<std::unique_ptr<ChunkColumn> > columns_;
+        std::vector<std::unique_ptr<Chunk> > chunks_;
+        std::size_t max_columns_, max_chunks_;
+        ChunkPoolStats stats_;
+
+        std::unique_ptr<Chunk> popChunk();
+
+        void releaseLocked(std::unique_ptr<Chunk> chunk);
+
+        void trimLocked();
+    };
+}
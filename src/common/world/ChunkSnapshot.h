@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "Chunk.h"
+#include "ChunkColumn.h"
+#include "Direction.h"
+
+namespace mc::world {
+    // versions a mesh reads: its chunk plus the six neighbours it samples border faces from, 0 = absent
+    struct ChunkVersions {
+        std::uint64_t chunk = 0;
+        std::array<std::uint64_t, DIRECTIONS_COUNT> neighbors{};
+
+        bool operator==(const ChunkVersions &) const = default;
+    };
+
+    // a chunk and its neighbours pinned at one version each; the copies share payloads with the live chunks, so
+    // any thread can read them while the owner keeps editing. capture on the thread that owns the column
+    class ChunkSnapshot {
+    public:
+        ChunkSnapshot(const ChunkColumn &column, int index) : chunk_{column.chunks()[index]->snapshot()}, index_{index} {
+            AdjacentChunks adjacent = column.adjacentChunks(index);
+            versions_.chunk = chunk_.version();
+            for (int i = 0; i < DIRECTIONS_COUNT; ++i)
+                if (adjacent[i]) {
+                    neighbors_[i] = adjacent[i]->snapshot();
+                    versions_.neighbors[i] = adjacent[i]->version();
+                }
+        }
+
+        // snapshots of the resident chunks of column within mask
+        static std::vector<ChunkSnapshot> capture(const ChunkColumn &column, ChunkMask mask) {
+            std::vector<ChunkSnapshot> snapshots;
+            for (int i = 0; i < CHUNKS_PER_COLUMN; ++i)
+                if (((mask >> i) & 1u) && column.chunks()[i]) snapshots.emplace_back(column, i);
+            return snapshots;
+        }
+
+        static ChunkVersions currentVersions(const ChunkColumn &column, int index) {
+            ChunkVersions versions;
+            if (const Chunk *chunk = column.chunks()[index].get()) versions.chunk = chunk->version();
+            AdjacentChunks adjacent = column.adjacentChunks(index);
+            for (int i = 0; i < DIRECTIONS_COUNT; ++i)
+                if (adjacent[i]) versions.neighbors[i] = adjacent[i]->version();
+            return versions;
+        }
+
+        const Chunk &chunk() const { return chunk_; }
+
+        AdjacentChunks neighbors() const {
+            AdjacentChunks adjacent{};
+            for (int i = 0; i < DIRECTIONS_COUNT; ++i)
+                if (neighbors_[i]) adjacent[i] = &*neighbors_[i];
+            return adjacent;
+        }
+
+        int index() const { return index_; }
+
+        const ChunkVersions &versions() const { return versions_; }
+
+    private:
+        Chunk chunk_;
+        std::array<std::optional<Chunk>, DIRECTIONS_COUNT> neighbors_{};
+        int index_;
+        ChunkVersions versions_;
+    };
+}
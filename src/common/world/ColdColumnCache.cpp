@@ -0,0 +1,74 @@
+#include <iterator>
+
+#include "ColdColumnCache.h"
+
+using namespace mc::world;
+
+void ColdColumnCache::insert(const glm::ivec2 &columnCoord, std::vector<std::uint8_t> payload) {
+    std::lock_guard lock(mutex_);
+    if (auto it = index_.find(columnCoord); it != index_.end()) eraseLocked(it->second);
+    if (payload.size() > budget_bytes_) return;
+
+    bytes_ += payload.size();
+    lru_.emplace_front(columnCoord, std::move(payload));
+    index_.emplace(columnCoord, lru_.begin());
+    ++stats_.inserted;
+    trimLocked();
+}
+
+std::optional<std::vector<std::uint8_t> > ColdColumnCache::take(const glm::ivec2 &columnCoord) {
+    std::lock_guard lock(mutex_);
+    auto it = index_.find(columnCoord);
+    if (it == index_.end()) {
+        ++stats_.misses;
+        return std::nullopt;
+    }
+
+    auto entry = it->second;
+    bytes_ -= entry->second.size();
+    std::vector<std::uint8_t> payload = std::move(entry->second);
+    index_.erase(it);
+    lru_.erase(entry);
+    ++stats_.hits;
+    return payload;
+}
+
+bool ColdColumnCache::contains(const glm::ivec2 &columnCoord) const {
+    std::lock_guard lock(mutex_);
+    return index_.contains(columnCoord);
+}
+
+void ColdColumnCache::clear() {
+    std::lock_guard lock(mutex_);
+    lru_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
+
+void ColdColumnCache::setBudget(std::size_t budgetBytes) {
+    std::lock_guard lock(mutex_);
+    budget_bytes_ = budgetBytes;
+    trimLocked();
+}
+
+ColdCacheStats ColdColumnCache::stats() const {
+    std::lock_guard lock(mutex_);
+    ColdCacheStats stats = stats_;
+    stats.columns = lru_.size();
+    stats.bytes = bytes_;
+    stats.budget_bytes = budget_bytes_;
+    return stats;
+}
+
+void ColdColumnCache::eraseLocked(std::list<Entry>::iterator it) {
+    bytes_ -= it->second.size();
+    index_.erase(it->first);
+    lru_.erase(it);
+}
+
+void ColdColumnCache::trimLocked() {
+    while (bytes_ > budget_bytes_) {
+        eraseLocked(std::prev(lru_.end()));
+        ++stats_.evicted;
+    }
+}
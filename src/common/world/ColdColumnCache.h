@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <glm/vec2.hpp>
+
+#include "WorldConstants.h"
+
+namespace mc::world {
+    struct ColdCacheStats {
+        std::uint64_t hits = 0, misses = 0;
+        std::uint64_t inserted = 0, evicted = 0; // evicted: pushed out by the byte budget
+        std::size_t columns = 0, bytes = 0, budget_bytes = 0;
+    };
+
+    // LRU of recently evicted columns kept as ColumnCodec payloads under a byte budget, so a column that
+    // comes back into the load radius is decoded instead of read from disk and regenerated.
+    // safe to use from generation workers
+    class ColdColumnCache {
+    public:
+        static constexpr std::size_t DEFAULT_BUDGET_BYTES = 32ull << 20;
+
+        explicit ColdColumnCache(std::size_t budgetBytes = DEFAULT_BUDGET_BYTES) : budget_bytes_{budgetBytes} {
+        }
+
+        void insert(const glm::ivec2 &columnCoord, std::vector<std::uint8_t> payload);
+
+        // removes and returns the payload, the column becomes hot again
+        std::optional<std::vector<std::uint8_t> > take(const glm::ivec2 &columnCoord);
+
+        bool contains(const glm::ivec2 &columnCoord) const;
+
+        void clear();
+
+        void setBudget(std::size_t budgetBytes);
+
+        ColdCacheStats stats() const;
+
+    private:
+        using Entry = std::pair<glm::ivec2, std::vector<std::uint8_t> >;
+
+        mutable std::mutex mutex_;
+        std::list<Entry> lru_; // most recently evicted first
+        std::unordered_map<glm::ivec2, std::list<Entry>::iterator, ColumnHash> index_;
+        std::size_t budget_bytes_;
+        std::size_t bytes_ = 0;
+        ColdCacheStats stats_;
+
+        void eraseLocked(std::list<Entry>::iterator it);
+
+        void trimLocked();
+    };
+}
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <array>
+
+#include "ColumnCodec.h"
+
+using namespace mc::world;
+
+static_assert(CHUNKS_PER_COLUMN <= 16, "ColumnCodec stores the present-chunk mask in 16 bits");
+
+namespace {
+    void putVarint(std::vector<std::uint8_t> &out, std::uint32_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<std::uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(v));
+    }
+
+    bool getVarint(std::span<const std::uint8_t> in, std::size_t &pos, std::uint32_t &v) {
+        v = 0;
+        for (int shift = 0; shift < 32 && pos < in.size(); shift += 7) {
+            std::uint8_t byte = in[pos++];
+            v |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    // byte ranges of each present chunk's runs
+    struct Layout {
+        std::uint16_t present = 0, loaded = 0;
+        std::array<std::span<const std::uint8_t>, CHUNKS_PER_COLUMN> chunks{};
+    };
+
+    bool parseLayout(std::span<const std::uint8_t> payload, Layout &layout) {
+        if (payload.size() < 3 || payload[0] < 1 || payload[0] > ColumnCodec::VERSION) return false;
+        layout.present = static_cast<std::uint16_t>(payload[1] | payload[2] << 8);
+        layout.loaded = static_cast<std::uint16_t>(ALL_CHUNKS);
+        std::size_t pos = 3;
+        if (payload[0] >= 2) {
+            if (payload.size() < 5) return false;
+            layout.loaded = static_cast<std::uint16_t>(payload[3] | payload[4] << 8);
+            pos = 5;
+        }
+
+        for (int i = 0; i < CHUNKS_PER_COLUMN; ++i) {
+            if (!(layout.present & (1u << i))) continue;
+            std::size_t begin = pos;
+            for (std::uint32_t index = 0; index < CHUNK_VOLUME;) {
+                std::uint32_t run;
+                if (!getVarint(payload, pos, run) || pos >= payload.size()) return false;
+                if (payload[pos++] >= NUM_BLOCKS || run == 0 || run > CHUNK_VOLUME - index) return false;
+                index += run;
+            }
+            layout.chunks[i] = payload.subspan(begin, pos - begin);
+        }
+        return pos == payload.size();
+    }
+}
+
+std::vector<std::uint8_t> ColumnCodec::encode(const ChunkColumn &column) {
+    std::vector<std::uint8_t> out;
+    out.push_back(VERSION);
+
+    std::uint16_t mask = 0;
+    for (int i = 0; i < CHUNKS_PER_COLUMN; ++i)
+        if (column.chunks()[i]) mask |= static_cast<std::uint16_t>(1u << i);
+    auto loaded = static_cast<std::uint16_t>(column.loadedMask());
+    out.push_back(static_cast<std::uint8_t>(mask));
+    out.push_back(static_cast<std::uint8_t>(mask >> 8));
+    out.push_back(static_cast<std::uint8_t>(loaded));
+    out.push_back(static_cast<std::uint8_t>(loaded >> 8));
+
+    for (const auto &chunk: column.chunks()) {
+        if (!chunk) continue;
+
+        if (chunk->isUniform()) {
+            putVarint(out, CHUNK_VOLUME);
+            out.push_back(static_cast<std::uint8_t>(chunk->uniformBlock()));
+            continue;
+        }
+
+        std::array<BlockId, CHUNK_VOLUME> blocks;
+        chunk->copyBlocks(blocks);
+
+        BlockId run_id = blocks[0];
+        std::uint32_t run = 0;
+        for (BlockId id: blocks) {
+            if (id != run_id) {
+                putVarint(out, run);
+                out.push_back(static_cast<std::uint8_t>(run_id));
+                run_id = id;
+                run = 0;
+            }
+            ++run;
+        }
+        putVarint(out, run);
+        out.push_back(static_cast<std::uint8_t>(run_id));
+    }
+    return out;
+}
+
+bool ColumnCodec::decode(std::span<const std::uint8_t> payload, ChunkColumn &column, ChunkColumnPool &pool,
+                         ChunkMask chunkMask) {
+    // version 1 payloads predate vertical streaming and always hold a whole column
+    if (payload.size() < 3 || payload[0] < 1 || payload[0] > VERSION) return false;
+    auto mask = static_cast<std::uint16_t>(payload[1] | payload[2] << 8);
+    ChunkMask loaded = ALL_CHUNKS;
+    std::size_t pos = 3;
+    if (payload[0] >= 2) {
+        if (payload.size() < 5) return false;
+        loaded = static_cast<std::uint16_t>(payload[3] | payload[4] << 8);
+        pos = 5;
+    }
+    chunkMask &= loaded & ~column.loadedMask();
+
+    auto fail = [&] {
+        for (int i = 0; i < CHUNKS_PER_COLUMN; ++i)
+            if ((chunkMask >> i) & 1u) pool.release(std::move(column.chunks()[i]));
+        return false;
+    };
+
+    std::array<BlockId, CHUNK_VOLUME> blocks;
+    for (int i = 0; i < CHUNKS_PER_COLUMN; ++i) {
+        if (!(mask & (1u << i))) continue;
+        bool wanted = (chunkMask >> i) & 1u;
+        glm::ivec3 chunk_coord(column.coord().x, i, column.coord().y);
+
+        std::uint32_t index = 0, runs = 0;
+        for (; index < CHUNK_VOLUME; ++runs) {
+            std::uint32_t run;
+            if (!getVarint(payload, pos, run) || pos >= payload.size()) return fail();
+            std::uint8_t id = payload[pos++];
+            if (id >= NUM_BLOCKS || run == 0 || run > CHUNK_VOLUME - index) return fail();
+
+            if (wanted) std::fill_n(blocks.begin() + index, run, static_cast<BlockId>(id));
+            index += run;
+        }
+        if (!wanted) continue;
+
+        // a single run shares the uniform payload, anything else is packed in one pass
+        if (runs == 1)
+            column.chunks()[i] = pool.acquireChunk(chunk_coord, blocks[0]);
+        else {
+            column.chunks()[i] = pool.acquireChunk(chunk_coord);
+            column.chunks()[i]->assignBlocks(blocks);
+        }
+    }
+    if (pos != payload.size()) return fail();
+    column.markLoaded(chunkMask);
+    return true;
+}
+
+std::vector<std::uint8_t> ColumnCodec::merge(std::span<const std::uint8_t> base, std::span<const std::uint8_t> update) {
+    Layout base_layout, update_layout;
+    if (!parseLayout(update, update_layout)) return {update.begin(), update.end()};
+    if (!parseLayout(base, base_layout)) base_layout = {};
+
+    std::uint16_t from_base = base_layout.loaded & ~update_layout.loaded;
+    auto present = static_cast<std::uint16_t>((base_layout.present & from_base) | update_layout.present);
+    auto loaded = static_cast<std::uint16_t>(base_layout.loaded | update_layout.loaded);
+
+    std::vector<std::uint8_t> out;
+    out.reserve(base.size() + update.size());
+    out.push_back(VERSION);
+    out.push_back(static_cast<std::uint8_t>(present));
+    out.push_back(static_cast<std::uint8_t>(present >> 8));
+    out.push_back(static_cast<std::uint8_t>(loaded));
+    out.push_back(static_cast<std::uint8_t>(loaded >> 8));
+
+    for (int i = 0; i < CHUNKS_PER_COLUMN; ++i) {
+        if (!(present & (1u << i))) continue;
+        std::span<const std::uint8_t> runs = (from_base & (1u << i)) ? base_layout.chunks[i] : update_layout.chunks[i];
+        out.insert(out.end(), runs.begin(), runs.end());
+    }
+    return out;
+}
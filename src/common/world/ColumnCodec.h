@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "ChunkColumn.h"
+#include "ChunkColumnPool.h"
+
+namespace mc::world {
+    // column payload: u8 version, u16 present-chunk mask, u16 loaded-chunk mask (since version 2), then per
+    // present chunk run-length encoded BlockIds in index order as {varint run, u8 id} until CHUNK_VOLUME is covered
+    class ColumnCodec {
+    public:
+        static constexpr std::uint8_t VERSION = 2;
+
+        static std::vector<std::uint8_t> encode(const ChunkColumn &column);
+
+        // loads the chunks of chunkMask that the payload holds and the column does not have yet;
+        // false (those chunks left unloaded) on a malformed payload
+        static bool decode(std::span<const std::uint8_t> payload, ChunkColumn &column, ChunkColumnPool &pool,
+                           ChunkMask chunkMask = ALL_CHUNKS);
+
+        // payload holding update's loaded chunks and base's for the rest, so a snapshot of part of a column
+        // can be written over an older one; a malformed base is ignored
+        static std::vector<std::uint8_t> merge(std::span<const std::uint8_t> base, std::span<const std::uint8_t> update);
+    };
+}
@@ -0,0 +1,102 @@
+#include <chrono>
+#include <exception>
+
+#include "ColumnPrefetcher.h"
+
+using namespace mc::world;
+
+ColumnPrefetcher::ColumnPrefetcher(RegionStore &store) : store_{store}, worker_{[this] { run(); }} {
+}
+
+ColumnPrefetcher::~ColumnPrefetcher() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    work_available_.notify_one();
+    worker_.join();
+}
+
+bool ColumnPrefetcher::request(const glm::ivec2 &columnCoord) {
+    {
+        std::lock_guard lock(mutex_);
+        if (entries_.contains(columnCoord)) return true;
+        if (queue_.size() >= MAX_QUEUED) {
+            ++stats_.rejected;
+            return false;
+        }
+
+        std::uint64_t ticket = next_ticket_++;
+        entries_.emplace(columnCoord, Entry{ticket, std::nullopt});
+        queue_.emplace_back(columnCoord, ticket);
+        ++stats_.requested;
+    }
+    work_available_.notify_one();
+    return true;
+}
+
+std::optional<StoredColumn> ColumnPrefetcher::take(const glm::ivec2 &columnCoord) {
+    std::lock_guard lock(mutex_);
+    auto it = entries_.find(columnCoord);
+    if (it == entries_.end() || !it->second.column) {
+        if (it != entries_.end()) entries_.erase(it);
+        ++stats_.misses;
+        return std::nullopt;
+    }
+
+    std::optional<StoredColumn> column = std::move(it->second.column);
+    entries_.erase(it);
+    ++stats_.hits;
+    return column;
+}
+
+void ColumnPrefetcher::invalidate(const glm::ivec2 &columnCoord) {
+    std::lock_guard lock(mutex_);
+    entries_.erase(columnCoord);
+}
+
+void ColumnPrefetcher::retain(const glm::ivec2 &centre, int radius) {
+    std::lock_guard lock(mutex_);
+    std::erase_if(entries_, [&](const auto &entry) {
+        glm::ivec2 d = entry.first - centre;
+        return d.x * d.x + d.y * d.y > radius * radius;
+    });
+}
+
+PrefetchStats ColumnPrefetcher::stats() const {
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+void ColumnPrefetcher::run() {
+    std::unique_lock lock(mutex_);
+    while (true) {
+        work_available_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_) return;
+
+        auto [column_coord, ticket] = queue_.front();
+        queue_.pop_front();
+
+        // skip reads abandoned while queued
+        auto it = entries_.find(column_coord);
+        if (it == entries_.end() || it->second.ticket != ticket) continue;
+
+        lock.unlock();
+        auto start = std::chrono::steady_clock::now();
+        std::optional<StoredColumn> column;
+        try {
+            column = store_.readColumn(column_coord);
+        } catch (const std::exception &) {
+            // left to the synchronous read in streaming, which reports the error
+        }
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        lock.lock();
+
+        stats_.read_us += us.count();
+        // the entry may have been taken or invalidated (and requested again) while reading
+        it = entries_.find(column_coord);
+        if (it == entries_.end() || it->second.ticket != ticket) continue;
+        if (column) it->second.column = std::move(column);
+        else entries_.erase(it);
+    }
+}
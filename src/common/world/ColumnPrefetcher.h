@@ -0,0 +1,71 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <glm/vec2.hpp>
+
+#include "EditJournal.h"
+#include "RegionStore.h"
+#include "WorldConstants.h"
+
+namespace mc::world {
+    struct PrefetchStats {
+        std::uint64_t requested = 0, rejected = 0; // rejected: read queue full
+        std::uint64_t hits = 0, misses = 0;
+        std::uint64_t read_us = 0; // spent by the I/O thread
+    };
+
+    // single background I/O thread reading columns ahead of the load radius into a bounded cache,
+    // so streaming finds their disk state in memory instead of blocking on reads
+    class ColumnPrefetcher {
+    public:
+        static constexpr std::size_t MAX_QUEUED = 512;
+
+        explicit ColumnPrefetcher(RegionStore &store);
+
+        ~ColumnPrefetcher();
+
+        ColumnPrefetcher(const ColumnPrefetcher &) = delete;
+
+        ColumnPrefetcher &operator=(const ColumnPrefetcher &) = delete;
+
+        // queues a read unless the column is already cached or queued; false when the queue is full
+        bool request(const glm::ivec2 &columnCoord);
+
+        // hands over a finished read; a read still queued or in flight counts as a miss and is abandoned
+        std::optional<StoredColumn> take(const glm::ivec2 &columnCoord);
+
+        // drops the cached read, e.g. after the column's disk state changed
+        void invalidate(const glm::ivec2 &columnCoord);
+
+        // drops every cached or queued read outside radius columns of centre
+        void retain(const glm::ivec2 &centre, int radius);
+
+        PrefetchStats stats() const;
+
+    private:
+        struct Entry {
+            std::uint64_t ticket;
+            std::optional<StoredColumn> column; // empty while queued or in flight
+        };
+
+        RegionStore &store_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable work_available_;
+        std::deque<std::pair<glm::ivec2, std::uint64_t> > queue_;
+        std::unordered_map<glm::ivec2, Entry, ColumnHash> entries_;
+        std::uint64_t next_ticket_ = 0;
+        bool stopping_ = false;
+        PrefetchStats stats_;
+
+        std::thread worker_;
+
+        void run();
+    };
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <glm/vec2.hpp>
+
+namespace mc::world {
+    // toroidal 2D index for a disk of columns around a moving centre: slot = coord mod (2 * RADIUS + 1),
+    // tagged with the full coord; two coords within RADIUS of the same centre can never share a slot
+    template<typename T, int RADIUS>
+    class ColumnRing {
+    public:
+        static constexpr int SIDE = 2 * RADIUS + 1;
+
+        ColumnRing() : slots_(SIDE * SIDE) {
+        }
+
+        T *find(const glm::ivec2 &coord) const {
+            const Slot &s = slot(coord);
+            return s.value && s.coord == coord ? s.value.get() : nullptr;
+        }
+
+        bool contains(const glm::ivec2 &coord) const { return find(coord) != nullptr; }
+
+        // stores value at coord and hands back what the slot held before, for the caller to retire: a value still
+        // at coord, or one from outside the radius that was never extracted. both are bugs upstream, but the value
+        // would otherwise go without being saved or recycled
+        std::unique_ptr<T> emplace(const glm::ivec2 &coord, std::unique_ptr<T> value) {
+            Slot &s = slot(coord);
+            if (!s.value) ++size_;
+            s.coord = coord;
+            return std::exchange(s.value, std::move(value));
+        }
+
+        std::unique_ptr<T> extract(const glm::ivec2 &coord) {
+            Slot &s = slot(coord);
+            if (!s.value || s.coord != coord) return nullptr;
+            --size_;
+            return std::move(s.value);
+        }
+
+        // moves every value whose coord matches into sink(coord, unique_ptr<T>)
+        template<typename Predicate, typename Sink>
+        void extractIf(Predicate predicate, Sink sink) {
+            for (Slot &s: slots_)
+                if (s.value && predicate(s.coord)) {
+                    --size_;
+                    sink(s.coord, std::move(s.value));
+                }
+        }
+
+        template<typename Predicate>
+        void eraseIf(Predicate predicate) {
+            extractIf(predicate, [](const glm::ivec2 &, std::unique_ptr<T>) {
+            });
+        }
+
+        void clear() {
+            for (Slot &s: slots_) s.value.reset();
+            size_ = 0;
+        }
+
+        std::size_t size() const { return size_; }
+
+        auto values() const {
+            return slots_
+                   | std::views::filter([](const Slot &s) { return s.value != nullptr; })
+                   | std::views::transform([](const Slot &s) -> T & { return *s.value; });
+        }
+
+    private:
+        struct Slot {
+            glm::ivec2 coord{};
+            std::unique_ptr<T> value;
+        };
+
+        std::vector<Slot> slots_;
+        std::size_t size_ = 0;
+
+        static int wrap(int v) {
+            int m = v % SIDE;
+            return m < 0 ? m + SIDE : m;
+        }
+
+        Slot &slot(const glm::ivec2 &coord) { return slots_[wrap(coord.y) * SIDE + wrap(coord.x)]; }
+        const Slot &slot(const glm::ivec2 &coord) const { return slots_[wrap(coord.y) * SIDE + wrap(coord.x)]; }
+    };
+}
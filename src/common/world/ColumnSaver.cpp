@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <bit>
+#include <exception>
+#include <utility>
+
+#include "ColumnSaver.h"
+#include "ColumnCodec.h"
+
+using namespace mc::world;
+
+namespace {
+    std::uint64_t elapsedMicroseconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+ColumnSaver::ColumnSaver(RegionStore &store, std::size_t bytesPerSecond)
+    : store_{store}, bytes_per_second_{bytesPerSecond}, worker_{[this] { run(); }} {
+}
+
+ColumnSaver::~ColumnSaver() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    work_available_.notify_one();
+    worker_.join();
+}
+
+SaveJob ColumnSaver::capture(const ChunkColumn &column, ChunkMask chunkMask, RegionStore &store) {
+    SaveJob job{std::make_unique<ChunkColumn>(column.coord()), store.journalMark(column.coord())};
+    for (int i = 0; i < CHUNKS_PER_COLUMN; ++i)
+        if (((chunkMask >> i) & 1u) && column.chunks()[i])
+            job.column->chunks()[i] = std::make_unique<Chunk>(column.chunks()[i]->snapshot());
+    job.column->markLoaded(chunkMask);
+    return job;
+}
+
+void ColumnSaver::submit(std::vector<SaveJob> jobs, std::uint64_t captureUs) {
+    if (jobs.empty()) return;
+    {
+        std::lock_guard lock(mutex_);
+        queue_.push_back({std::move(jobs), captureUs, std::chrono::steady_clock::now()});
+    }
+    work_available_.notify_one();
+}
+
+bool ColumnSaver::idle() const {
+    std::lock_guard lock(mutex_);
+    return queue_.empty() && !writing_;
+}
+
+std::vector<SaveCycle> ColumnSaver::takeFinished() {
+    std::lock_guard lock(mutex_);
+    return std::exchange(finished_, {});
+}
+
+void ColumnSaver::setBandwidth(std::size_t bytesPerSecond) {
+    std::lock_guard lock(mutex_);
+    bytes_per_second_ = bytesPerSecond;
+}
+
+SaveStats ColumnSaver::stats() const {
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+void ColumnSaver::run() {
+    auto next_write = std::chrono::steady_clock::now();
+    auto last_journal_sync = next_write;
+
+    std::unique_lock lock(mutex_);
+    while (true) {
+        bool woken = work_available_.wait_for(lock, JOURNAL_SYNC_INTERVAL,
+                                              [this] { return stopping_ || !queue_.empty(); });
+        syncJournalsIfDue(lock, last_journal_sync);
+        if (!woken) continue;
+        if (queue_.empty()) return;
+
+        Cycle cycle = std::move(queue_.front());
+        queue_.pop_front();
+        writing_ = true;
+
+        SaveCycle report{0, 0, 0, cycle.capture_us, 0};
+        for (const SaveJob &job: cycle.jobs) {
+            // token bucket: each write pushes the next one back by its share of the cap
+            auto throttle_start = std::chrono::steady_clock::now();
+            if (work_available_.wait_until(lock, next_write, [this] { return stopping_; }))
+                next_write = std::chrono::steady_clock::now();
+            stats_.throttled_us += elapsedMicroseconds(throttle_start);
+            std::size_t bytes_per_second = bytes_per_second_;
+            syncJournalsIfDue(lock, last_journal_sync);
+
+            lock.unlock();
+            auto start = std::chrono::steady_clock::now();
+            std::uint64_t bytes = 0;
+            bool failed = false;
+            try {
+                bytes = save(job);
+            } catch (const std::exception &) {
+                // the edits stay journaled, the next save of the column retries
+                failed = true;
+            }
+            std::uint64_t write_us = elapsedMicroseconds(start);
+            lock.lock();
+
+            next_write = std::max(next_write, start) + std::chrono::microseconds(
+                             bytes_per_second ? bytes * 1'000'000 / bytes_per_second : 0);
+            stats_.write_us += write_us;
+            if (failed) {
+                ++stats_.failed;
+                continue;
+            }
+            report.columns += 1;
+            report.chunks += std::popcount(job.column->loadedMask());
+            report.bytes += bytes;
+        }
+
+        report.latency_us = elapsedMicroseconds(cycle.submitted);
+        stats_.cycles += 1;
+        stats_.columns += report.columns;
+        stats_.chunks += report.chunks;
+        stats_.bytes += report.bytes;
+        finished_.push_back(report);
+        writing_ = false;
+    }
+}
+
+void ColumnSaver::syncJournalsIfDue(std::unique_lock<std::mutex> &lock,
+                                    std::chrono::steady_clock::time_point &lastSync) {
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastSync < JOURNAL_SYNC_INTERVAL) return;
+    lastSync = now;
+
+    lock.unlock();
+    store_.syncJournals();
+    lock.lock();
+}
+
+std::uint64_t ColumnSaver::save(const SaveJob &job) {
+    const ChunkColumn &column = *job.column;
+    std::vector<std::uint8_t> payload = ColumnCodec::encode(column);
+    if (column.loadedMask() != ALL_CHUNKS)
+        if (std::optional<std::vector<std::uint8_t> > base = store_.read(column.coord()))
+            payload = ColumnCodec::merge(*base, payload);
+
+    // the snapshot is on the disk before the edits are dropped; a crash in between replays them over it again,
+    // a failed write throws with the edits still journaled
+    store_.write(column.coord(), payload);
+    store_.dropEdits(column.coord(), column.loadedMask(), job.journal_mark);
+    return payload.size();
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ChunkColumn.h"
+#include "RegionStore.h"
+#include "WorldConstants.h"
+
+namespace mc::world {
+    struct SaveJob {
+        std::unique_ptr<ChunkColumn> column; // pinned copies of the chunks to save, loaded mask = those chunks
+        std::uint64_t journal_mark = 0; // the journaled edits below it are part of the copies
+    };
+
+    // one submitted batch of jobs, reported once written
+    struct SaveCycle {
+        std::size_t columns = 0, chunks = 0;
+        std::uint64_t bytes = 0;
+        std::uint64_t capture_us = 0; // on the submitting thread, pinning the chunks
+        std::uint64_t latency_us = 0; // submit to last write, throttling included
+    };
+
+    struct SaveStats {
+        std::uint64_t cycles = 0, columns = 0, chunks = 0, failed = 0;
+        std::uint64_t bytes = 0, write_us = 0, throttled_us = 0;
+    };
+
+    // the single writer of region file snapshots: encodes pinned chunk copies on its own thread, merges them
+    // over the column's previous snapshot, writes it and then drops the journaled edits it covers. one thread
+    // keeps writes to a column in submission order, so an older copy never lands over a newer one. between
+    // writes it also syncs the edit journals, which spares the thread appending edits the wait
+    class ColumnSaver {
+    public:
+        static constexpr std::size_t DEFAULT_BYTES_PER_SECOND = 4ull << 20;
+        // the most edits a power loss can take: those appended since the last journal sync
+        static constexpr std::chrono::milliseconds JOURNAL_SYNC_INTERVAL{1000};
+
+        explicit ColumnSaver(RegionStore &store, std::size_t bytesPerSecond = DEFAULT_BYTES_PER_SECOND);
+
+        // writes out whatever is still queued, ignoring the bandwidth cap
+        ~ColumnSaver();
+
+        ColumnSaver(const ColumnSaver &) = delete;
+
+        ColumnSaver &operator=(const ColumnSaver &) = delete;
+
+        // pins the chunks of chunkMask; on the thread that edits the column, like recordEdit
+        static SaveJob capture(const ChunkColumn &column, ChunkMask chunkMask, RegionStore &store);
+
+        void submit(std::vector<SaveJob> jobs, std::uint64_t captureUs = 0);
+
+        // nothing queued or being written
+        bool idle() const;
+
+        // cycles written since the last call
+        std::vector<SaveCycle> takeFinished();
+
+        void setBandwidth(std::size_t bytesPerSecond);
+
+        SaveStats stats() const;
+
+    private:
+        struct Cycle {
+            std::vector<SaveJob> jobs;
+            std::uint64_t capture_us;
+            std::chrono::steady_clock::time_point submitted;
+        };
+
+        RegionStore &store_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable work_available_;
+        std::deque<Cycle> queue_;
+        std::vector<SaveCycle> finished_;
+        std::size_t bytes_per_second_;
+        bool writing_ = false;
+        bool stopping_ = false;
+        SaveStats stats_;
+
+        std::thread worker_;
+
+        void run();
+
+        // syncs the journals once JOURNAL_SYNC_INTERVAL has passed since the last time, with lock released meanwhile
+        void syncJournalsIfDue(std::unique_lock<std::mutex> &lock, std::chrono::steady_clock::time_point &lastSync);
+
+        // bytes written
+        std::uint64_t save(const SaveJob &job);
+    };
+}
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <cmath>
+
+#include "DensityField.h"
+
+using namespace mc::world;
+
+namespace {
+    // by solid voxels counted down from the last air above, capped at DIRT_DEPTH + 1
+    constexpr std::array<BlockId, DensityField::DIRT_DEPTH + 2> BLOCK_BY_DEPTH = {
+        BlockId::Air, BlockId::Grass, BlockId::Dirt, BlockId::Dirt, BlockId::Dirt, BlockId::Stone
+    };
+}
+
+float DensityField::density(int wx, int wy, int wz) const {
+    float d = static_cast<float>(SURFACE_Y - wy) / SQUASH;
+    float amplitude = 1.f, frequency = 1.f / SCALE;
+    for (int octave = 0; octave < OCTAVES; ++octave) {
+        d += amplitude * terrain_.noise(static_cast<float>(wx) * frequency, static_cast<float>(wy) * frequency,
+                                        static_cast<float>(wz) * frequency);
+        amplitude *= 0.5f;
+        frequency *= 2.f;
+    }
+    if (d <= 0.f || wy < CAVE_MIN_Y) return d;
+
+    float cx = static_cast<float>(wx) / CAVE_SCALE;
+    float cy = static_cast<float>(wy) / CAVE_SCALE;
+    float cz = static_cast<float>(wz) / CAVE_SCALE;
+    float cave = std::max(std::fabs(cave_a_.noise(cx, cy, cz)), std::fabs(cave_b_.noise(cx, cy, cz))) - CAVE_RADIUS;
+    return std::min(d, cave);
+}
+
+void DensityField::sampleLattice(const glm::ivec3 &chunkCoord, std::array<float, LATTICE_VOLUME> &lattice) const {
+    glm::ivec3 origin = chunkCoord * CHUNK_XYZ;
+    int i = 0;
+    for (int ly = 0; ly < LATTICE_Y; ++ly)
+        for (int lz = 0; lz < LATTICE_XZ; ++lz)
+            for (int lx = 0; lx < LATTICE_XZ; ++lx)
+                lattice[i++] = density(origin.x + lx * CELL_XZ, origin.y + ly * CELL_Y, origin.z + lz * CELL_XZ);
+}
+
+std::optional<BlockId> DensityField::fillChunk(const glm::ivec3 &chunkCoord,
+                                               std::span<BlockId, CHUNK_VOLUME> blocks) const {
+    int min_y = chunkCoord.y * CHUNK_XYZ;
+    if (min_y > MAX_SURFACE_Y) return BlockId::Air;
+
+    std::array<float, LATTICE_VOLUME> lattice;
+    sampleLattice(chunkCoord, lattice);
+
+    // interpolation stays within the range of the lattice, so a chunk solid or empty at every lattice point is
+    // that throughout; solid includes the layers above it, so its top is past the dirt
+    auto [lowest, highest] = std::ranges::minmax(lattice);
+    if (highest <= 0.f) return BlockId::Air;
+    if (lowest > 0.f && min_y > 0) return BlockId::Stone;
+
+    // every lattice layer bilinearly to a full xz plane, along x per lattice row and then along z
+    std::array<float, LATTICE_Y * CHUNK_SLICE_VOLUME> planes;
+    std::array<float, LATTICE_XZ * CHUNK_XYZ> rows;
+    for (int ly = 0; ly < LATTICE_Y; ++ly) {
+        const float *layer = lattice.data() + ly * LATTICE_XZ * LATTICE_XZ;
+        for (int lz = 0; lz < LATTICE_XZ; ++lz)
+            for (int x = 0; x < CHUNK_XYZ; ++x) {
+                const float *cell = layer + lz * LATTICE_XZ + x / CELL_XZ;
+                float t = static_cast<float>(x % CELL_XZ) * (1.f / CELL_XZ);
+                rows[lz * CHUNK_XYZ + x] = cell[0] + t * (cell[1] - cell[0]);
+            }
+
+        float *plane = planes.data() + ly * CHUNK_SLICE_VOLUME;
+        for (int z = 0; z < CHUNK_XYZ; ++z) {
+            const float *a = rows.data() + z / CELL_XZ * CHUNK_XYZ;
+            const float *b = a + CHUNK_XYZ;
+            float t = static_cast<float>(z % CELL_XZ) * (1.f / CELL_XZ);
+            for (int x = 0; x < CHUNK_XYZ; ++x) plane[z * CHUNK_XYZ + x] = a[x] + t * (b[x] - a[x]);
+        }
+    }
+
+    // top down from DIRT_DEPTH layers above the chunk, each layer a lerp of two planes and a depth count over
+    // contiguous CHUNK_SLICE_VOLUME runs, which the compiler turns into vector code
+    std::array<std::uint8_t, CHUNK_SLICE_VOLUME> depth{};
+    for (int y = CHUNK_XYZ + DIRT_DEPTH; y-- > 0;) {
+        const float *a = planes.data() + y / CELL_Y * CHUNK_SLICE_VOLUME;
+        const float *b = a + CHUNK_SLICE_VOLUME;
+        float t = static_cast<float>(y % CELL_Y) * (1.f / CELL_Y);
+        for (int c = 0; c < CHUNK_SLICE_VOLUME; ++c) {
+            bool solid = a[c] + t * (b[c] - a[c]) > 0.f;
+            depth[c] = solid ? static_cast<std::uint8_t>(std::min(depth[c] + 1, DIRT_DEPTH + 1)) : 0;
+        }
+        if (y >= CHUNK_XYZ) continue;
+
+        auto layer = blocks.begin() + y * CHUNK_SLICE_VOLUME;
+        if (min_y + y == 0) std::fill_n(layer, CHUNK_SLICE_VOLUME, BlockId::Bedrock);
+        else
+            for (int c = 0; c < CHUNK_SLICE_VOLUME; ++c) layer[c] = BLOCK_BY_DEPTH[depth[c]];
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <glm/vec3.hpp>
+
+#include "Chunk.h"
+#include "PerlinNoise.h"
+#include "WorldConstants.h"
+
+namespace mc::world {
+    // 3d terrain, solid wherever
+    //   density = (SURFACE_Y - y) / SQUASH + fbm(p / SCALE)
+    // is positive, with worm caves carved where two more noise fields are both near zero. the field is only
+    // sampled on a coarse lattice, CELL_XZ x CELL_Y x CELL_XZ voxels per cell, and trilinearly interpolated
+    class DensityField {
+    public:
+        static constexpr int CELL_XZ = 4;
+        static constexpr int CELL_Y = 8;
+        static constexpr int LATTICE_XZ = CHUNK_XYZ / CELL_XZ + 1;
+        // one layer past the chunk top, for the dirt depth of its top layers
+        static constexpr int LATTICE_Y = CHUNK_XYZ / CELL_Y + 2;
+        static constexpr int LATTICE_VOLUME = LATTICE_Y * LATTICE_XZ * LATTICE_XZ;
+
+        static constexpr int SURFACE_Y = 96;
+        static constexpr float SQUASH = 40.f;
+        static constexpr float SCALE = 64.f;
+        static constexpr int OCTAVES = 4;
+        static constexpr float CAVE_SCALE = 48.f;
+        static constexpr float CAVE_RADIUS = 0.15f;
+        static constexpr int CAVE_MIN_Y = 8;
+        static constexpr int DIRT_DEPTH = 4; // grass and the dirt below it
+
+        explicit DensityField(std::uint32_t seed = 0)
+            : terrain_{seed}, cave_a_{seed ^ 0x9e3779b9u}, cave_b_{seed ^ 0x85ebca6bu} {
+        }
+
+        // fills blocks with the chunk at chunkCoord, or returns the block it is made of entirely without touching
+        // them: air above the highest reachable surface, stone when every lattice point of it is solid
+        std::optional<BlockId> fillChunk(const glm::ivec3 &chunkCoord, std::span<BlockId, CHUNK_VOLUME> blocks) const;
+
+        float density(int wx, int wy, int wz) const;
+
+    private:
+        PerlinNoise terrain_, cave_a_, cave_b_;
+
+        // |fbm| stays below the sum of its octave amplitudes, 2 - 2^(1 - OCTAVES), with some slack for the noise
+        // overshooting [-1, 1]; no y above SURFACE_Y + SQUASH * that can be solid
+        static constexpr int MAX_SURFACE_Y = SURFACE_Y + static_cast<int>(SQUASH * 2.f * 1.1f);
+
+        void sampleLattice(const glm::ivec3 &chunkCoord, std::array<float, LATTICE_VOLUME> &lattice) const;
+    };
+}
@@ -31,6 +31,11 @@ namespace mc::world {
         return static_cast<Direction>(static_cast<std::uint8_t>(direction) ^ 1u);
     }
 
+    // axis 0/1/2 = X/Y/Z, sign of the step along it
+    constexpr Direction axisDirection(int axis, int sign) {
+        return static_cast<Direction>(axis * 2 + (sign < 0 ? 1 : 0));
+    }
+
     constexpr std::array DIRECTIONS = {
         Direction::PositiveX, Direction::NegativeX,
         Direction::PositiveY, Direction::NegativeY,
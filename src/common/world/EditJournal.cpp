@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "EditJournal.h"
+#include "core/FileSync.h"
+
+using namespace mc::world;
+
+namespace {
+    // record: u16 column slot, u8 block id, u8 checksum, u32 position (x | z << 5 | y << 10)
+    using Record = std::array<std::uint8_t, EditJournal::RECORD_BYTES>;
+
+    std::uint8_t checksum(const Record &record) {
+        // salted so a zero-filled tail never validates
+        std::uint8_t sum = 0x5A;
+        for (int i = 0; i < static_cast<int>(record.size()); ++i)
+            if (i != 3) sum = static_cast<std::uint8_t>((sum << 1 | sum >> 7) ^ record[i]);
+        return sum;
+    }
+
+    std::uint32_t packPosition(const glm::ivec3 &localCoord) {
+        return static_cast<std::uint32_t>(localCoord.x | localCoord.z << CHUNK_BITS | localCoord.y << 2 * CHUNK_BITS);
+    }
+
+    glm::ivec3 unpackPosition(std::uint32_t position) {
+        return {
+            static_cast<int>(position & CHUNK_MASK),
+            static_cast<int>(position >> 2 * CHUNK_BITS),
+            static_cast<int>((position >> CHUNK_BITS) & CHUNK_MASK)
+        };
+    }
+
+    Record encodeRecord(int slot, const BlockEdit &edit) {
+        std::uint32_t position = packPosition(edit.local_coord);
+        Record record{
+            static_cast<std::uint8_t>(slot), static_cast<std::uint8_t>(slot >> 8),
+            static_cast<std::uint8_t>(edit.id), 0,
+            static_cast<std::uint8_t>(position), static_cast<std::uint8_t>(position >> 8),
+            static_cast<std::uint8_t>(position >> 16), static_cast<std::uint8_t>(position >> 24)
+        };
+        record[3] = checksum(record);
+        return record;
+    }
+
+    bool decodeRecord(const Record &record, int &slot, BlockEdit &edit) {
+        if (record[3] != checksum(record)) return false;
+        slot = record[0] | record[1] << 8;
+        std::uint32_t position = record[4] | record[5] << 8 | record[6] << 16 | static_cast<std::uint32_t>(record[7]) << 24;
+        edit = {unpackPosition(position), static_cast<BlockId>(record[2])};
+        return slot < REGION_COLUMNS && record[2] < NUM_BLOCKS && edit.local_coord.y <= MAX_WORLD_Y;
+    }
+
+    bool inMask(const BlockEdit &edit, ChunkMask chunkMask) {
+        return (chunkMask >> (edit.local_coord.y >> CHUNK_BITS)) & 1u;
+    }
+
+    void writeRecord(std::ofstream &file, const Record &record) {
+        file.write(reinterpret_cast<const char *>(record.data()), static_cast<std::streamsize>(record.size()));
+    }
+}
+
+EditJournal::EditJournal(std::filesystem::path path) : path_(std::move(path)) {
+    std::uintmax_t valid_bytes = 0;
+    if (std::ifstream in{path_, std::ios::binary}) {
+        Record record;
+        while (in.read(reinterpret_cast<char *>(record.data()), static_cast<std::streamsize>(record.size()))) {
+            int slot;
+            BlockEdit edit;
+            if (!decodeRecord(record, slot, edit)) break;
+            edits_[slot].push_back({edit, next_sequence_++});
+            valid_bytes += record.size();
+            ++records_;
+        }
+    }
+
+    // drop whatever a crash left after the last whole record before appending behind it
+    if (std::filesystem::exists(path_) && std::filesystem::file_size(path_) != valid_bytes)
+        std::filesystem::resize_file(path_, valid_bytes);
+
+    next_compaction_ = std::max(MIN_COMPACTION_RECORDS, 2 * records_);
+    entry_synced_ = std::filesystem::exists(path_);
+    file_.open(path_, std::ios::binary | std::ios::app);
+    if (!file_) throw std::runtime_error("Failed to open edit journal " + path_.string());
+}
+
+EditJournal::~EditJournal() {
+    sync();
+}
+
+void EditJournal::append(const glm::ivec2 &columnCoord, const BlockEdit &edit) {
+    std::lock_guard lock(mutex_);
+    int index = slot(columnCoord);
+    writeRecord(file_, encodeRecord(index, edit));
+    file_.flush();
+    if (!file_) throw std::runtime_error("Failed to append to edit journal " + path_.string());
+    unsynced_ = true;
+
+    edits_[index].push_back({edit, next_sequence_++});
+    ++records_;
+}
+
+std::vector<BlockEdit> EditJournal::edits(const glm::ivec2 &columnCoord) const {
+    std::lock_guard lock(mutex_);
+    const std::vector<Entry> &entries = edits_[slot(columnCoord)];
+    std::vector<BlockEdit> edits;
+    edits.reserve(entries.size());
+    for (const Entry &entry: entries) edits.push_back(entry.edit);
+    return edits;
+}
+
+std::size_t EditJournal::editCount(const glm::ivec2 &columnCoord, ChunkMask chunkMask) const {
+    std::lock_guard lock(mutex_);
+    const std::vector<Entry> &entries = edits_[slot(columnCoord)];
+    if (chunkMask == ALL_CHUNKS) return entries.size();
+    return std::ranges::count_if(entries, [&](const Entry &entry) { return inMask(entry.edit, chunkMask); });
+}
+
+std::uint64_t EditJournal::mark() const {
+    std::lock_guard lock(mutex_);
+    return next_sequence_;
+}
+
+void EditJournal::drop(const glm::ivec2 &columnCoord, ChunkMask chunkMask, std::uint64_t before) {
+    // the records stay in the log until it is next compacted: replayed in order over the snapshot they only set
+    // blocks to what it holds or to what a later record sets them to anyway
+    std::lock_guard lock(mutex_);
+    std::erase_if(edits_[slot(columnCoord)], [&](const Entry &entry) {
+        return entry.sequence < before && inMask(entry.edit, chunkMask);
+    });
+}
+
+bool EditJournal::sync() {
+    bool compaction_due;
+    {
+        std::lock_guard lock(mutex_);
+        compaction_due = records_ >= next_compaction_ && !compacting_;
+    }
+    if (compaction_due) {
+        try {
+            compact();
+        } catch (const std::exception &) {
+            // the old log is still in place, the next sync tries again
+            return false;
+        }
+    }
+
+    bool sync_entry;
+    {
+        std::lock_guard lock(mutex_);
+        if (!unsynced_) return true;
+        unsynced_ = false;
+        sync_entry = !entry_synced_;
+        entry_synced_ = true;
+    }
+
+    // the disk is waited on outside the lock, an append made meanwhile is left for the next sync
+    if (core::syncFile(path_) && (!sync_entry || core::syncDirectory(path_.parent_path()))) return true;
+
+    std::lock_guard lock(mutex_);
+    unsynced_ = true;
+    if (sync_entry) entry_synced_ = false;
+    return false;
+}
+
+std::size_t EditJournal::records() const {
+    std::lock_guard lock(mutex_);
+    return records_;
+}
+
+void EditJournal::compact() {
+    // a copy of the edits made so far is compacted, written and synced beside the log without the lock, appends
+    // only wait for the few records made meanwhile to be added and the new log swapped in
+    Edits edits;
+    std::uint64_t copied_before;
+    {
+        std::lock_guard lock(mutex_);
+        if (compacting_) return;
+        compacting_ = true;
+        edits = edits_;
+        copied_before = next_sequence_;
+    }
+    try {
+        rewrite(std::move(edits), copied_before);
+    } catch (const std::exception &) {
+        std::lock_guard lock(mutex_);
+        compacting_ = false;
+        throw;
+    }
+}
+
+void EditJournal::rewrite(Edits kept, std::uint64_t copiedBefore) {
+    // the last edit per block, and per column the sequences of those it supersedes, in order
+    std::array<std::vector<std::uint64_t>, REGION_COLUMNS> superseded;
+    std::unordered_map<std::uint32_t, std::size_t> last_edit;
+    for (int i = 0; i < REGION_COLUMNS; ++i) {
+        std::vector<Entry> &edits = kept[i];
+        if (edits.empty()) continue;
+        last_edit.clear();
+        for (std::size_t j = 0; j < edits.size(); ++j) last_edit[packPosition(edits[j].edit.local_coord)] = j;
+
+        std::vector<Entry> last;
+        last.reserve(last_edit.size());
+        for (std::size_t j = 0; j < edits.size(); ++j) {
+            if (last_edit[packPosition(edits[j].edit.local_coord)] == j) last.push_back(edits[j]);
+            else superseded[i].push_back(edits[j].sequence);
+        }
+        edits = std::move(last);
+    }
+
+    // written beside the old log and swapped in, so a crash leaves one of the two intact
+    std::filesystem::path tmp_path = path_;
+    tmp_path += ".tmp";
+    std::size_t records = 0;
+    {
+        std::ofstream tmp(tmp_path, std::ios::binary | std::ios::trunc);
+        for (int i = 0; i < REGION_COLUMNS; ++i)
+            for (const Entry &entry: kept[i]) writeRecord(tmp, encodeRecord(i, entry.edit));
+        tmp.flush();
+        if (!tmp) throw std::runtime_error("Failed to compact edit journal " + path_.string());
+        records = static_cast<std::size_t>(tmp.tellp()) / RECORD_BYTES;
+    }
+    // on disk before it replaces the old log: a rename landing first could leave an empty journal behind
+    if (!core::syncFile(tmp_path)) throw std::runtime_error("Failed to sync compacted edit journal " + path_.string());
+
+    std::lock_guard lock(mutex_);
+    {
+        std::ofstream tmp(tmp_path, std::ios::binary | std::ios::app);
+        for (int i = 0; i < REGION_COLUMNS; ++i)
+            for (const Entry &entry: edits_[i])
+                if (entry.sequence >= copiedBefore) {
+                    writeRecord(tmp, encodeRecord(i, entry.edit));
+                    ++records;
+                }
+        tmp.flush();
+        if (!tmp) throw std::runtime_error("Failed to compact edit journal " + path_.string());
+    }
+
+    file_.close();
+    std::filesystem::rename(tmp_path, path_);
+    file_.open(path_, std::ios::binary | std::ios::app);
+    if (!file_) throw std::runtime_error("Failed to reopen edit journal " + path_.string());
+    // the rename and the records added under the lock reach the disk with the next sync
+    unsynced_ = true;
+    entry_synced_ = false;
+
+    // both in sequence order; an edit dropped meanwhile is just not found
+    for (int i = 0; i < REGION_COLUMNS; ++i) {
+        if (superseded[i].empty()) continue;
+        auto next = superseded[i].begin();
+        std::erase_if(edits_[i], [&](const Entry &entry) {
+            while (next != superseded[i].end() && *next < entry.sequence) ++next;
+            return next != superseded[i].end() && *next == entry.sequence;
+        });
+    }
+    records_ = records;
+    next_compaction_ = std::max(MIN_COMPACTION_RECORDS, 2 * records_);
+    compacting_ = false;
+}
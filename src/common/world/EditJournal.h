@@ -0,0 +1,95 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include "Block.h"
+#include "RegionFile.h"
+#include "WorldConstants.h"
+
+namespace mc::world {
+    struct BlockEdit {
+        glm::ivec3 local_coord; // x/z within the column, y in world space
+        BlockId id;
+    };
+
+    // append-only log of block edits for the columns of one region; replayed over freshly generated (or
+    // snapshotted) terrain. each record is flushed as it is made and carries a checksum, so a torn tail
+    // left by a crash is detected and truncated on open. flushed records survive the process, not the machine:
+    // they reach the disk on sync(), which ColumnSaver calls every JOURNAL_SYNC_INTERVAL, and on close, so a
+    // power loss can take up to that interval of edits with it. appends never wait on the disk: compaction and
+    // syncing happen in sync(), on the thread calling it
+    class EditJournal {
+    public:
+        static constexpr std::size_t RECORD_BYTES = 8;
+        // the log is rewritten with only the last edit per block by the first sync after it doubles past its
+        // compacted size
+        static constexpr std::size_t MIN_COMPACTION_RECORDS = 4096;
+
+        explicit EditJournal(std::filesystem::path path);
+
+        ~EditJournal();
+
+        EditJournal(const EditJournal &) = delete;
+
+        EditJournal &operator=(const EditJournal &) = delete;
+
+        void append(const glm::ivec2 &columnCoord, const BlockEdit &edit);
+
+        // edits of one column in the order they were made
+        std::vector<BlockEdit> edits(const glm::ivec2 &columnCoord) const;
+
+        // edits of one column falling in the chunks of chunkMask
+        std::size_t editCount(const glm::ivec2 &columnCoord, ChunkMask chunkMask = ALL_CHUNKS) const;
+
+        // sequence number the next append gets; edits made before a snapshot was taken are those below its mark
+        std::uint64_t mark() const;
+
+        // forgets a column's edits in chunkMask made before mark, once they are part of a region file snapshot;
+        // their records leave the log with the next compaction
+        void drop(const glm::ivec2 &columnCoord, ChunkMask chunkMask = ALL_CHUNKS,
+                  std::uint64_t before = std::numeric_limits<std::uint64_t>::max());
+
+        // rewrites the log with only the last edit per block, holding up appends just to swap it in; throws when
+        // the new log could not be written, the old one stays. the swap reaches the disk with the next sync
+        void compact();
+
+        // compacts the log if it is due, then forces the records appended since the last sync onto the disk, without
+        // holding up appends meanwhile; false when either failed, the next sync tries again
+        bool sync();
+
+        std::size_t records() const;
+
+    private:
+        struct Entry {
+            BlockEdit edit;
+            std::uint64_t sequence; // in memory only, renumbered on open
+        };
+
+        using Edits = std::array<std::vector<Entry>, REGION_COLUMNS>;
+
+        mutable std::mutex mutex_;
+        std::filesystem::path path_;
+        std::ofstream file_;
+        Edits edits_{};
+        std::uint64_t next_sequence_ = 0;
+        std::size_t records_ = 0;
+        std::size_t next_compaction_ = MIN_COMPACTION_RECORDS;
+        bool unsynced_ = false; // records appended since the last sync
+        bool entry_synced_ = true; // the file's own entry in its directory, false for a file created by this journal
+        bool compacting_ = false;
+
+        static int slot(const glm::ivec2 &columnCoord) {
+            return (columnCoord.y & REGION_MASK) * REGION_XZ + (columnCoord.x & REGION_MASK);
+        }
+
+        // compacts kept, the edits made before copiedBefore, into a new log and swaps it in with those made since
+        void rewrite(Edits kept, std::uint64_t copiedBefore);
+    };
+}
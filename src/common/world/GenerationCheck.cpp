@@ -0,0 +1,114 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "GenerationCheck.h"
+#include "ChunkColumn.h"
+#include "ChunkColumnPool.h"
+
+using namespace mc::world;
+
+namespace {
+    constexpr std::uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+    constexpr std::uint64_t FNV_PRIME = 0x100000001b3ull;
+
+    struct GoldenHash {
+        TerrainGenerationMode mode;
+        std::uint32_t seed;
+        std::uint64_t hash;
+    };
+
+    // little-endian hosts; regenerate with the server's --verify-generation after an intended change
+    constexpr GoldenHash GOLDEN_HASHES[] = {
+        {TerrainGenerationMode::SineWave, 0, 0xc2b7a5d77164f798ull},
+        {TerrainGenerationMode::SineWave, 1337, 0xe946e9f3bf64bc9full},
+        {TerrainGenerationMode::SineWave, 0xdeadbeef, 0x15df60ccc3ef6044ull},
+        {TerrainGenerationMode::PerlinNoise, 0, 0x64bbee953a249e85ull},
+        {TerrainGenerationMode::PerlinNoise, 1337, 0x08725dac8749ff12ull},
+        {TerrainGenerationMode::PerlinNoise, 0xdeadbeef, 0xb5ef9d99d7ce2c7cull},
+        {TerrainGenerationMode::Density3D, 0, 0xa4746ba176901939ull},
+        {TerrainGenerationMode::Density3D, 1337, 0x6bceeccefb3cc413ull},
+        {TerrainGenerationMode::Density3D, 0xdeadbeef, 0xe226722a6ea61a9dull},
+    };
+
+    // a 6x6 block around the origin, borders between negative and positive coordinates included, and a 4x4
+    // block far enough out for float noise inputs to lose precision
+    std::vector<glm::ivec2> checkedColumns() {
+        std::vector<glm::ivec2> columns;
+        for (int z = -3; z < 3; ++z)
+            for (int x = -3; x < 3; ++x) columns.emplace_back(x, z);
+        for (int z = 0; z < 4; ++z)
+            for (int x = 0; x < 4; ++x) columns.emplace_back(2100 + x, -2100 + z);
+        return columns;
+    }
+
+    std::uint64_t hashBlocks(std::uint64_t h, std::span<const BlockId, CHUNK_VOLUME> blocks) {
+        for (std::size_t i = 0; i < blocks.size(); i += sizeof(std::uint64_t)) {
+            std::uint64_t word;
+            std::memcpy(&word, blocks.data() + i, sizeof(word));
+            h = (h ^ word) * FNV_PRIME;
+        }
+        return h;
+    }
+}
+
+std::uint64_t GenerationCheck::hashColumn(const ChunkColumn &column) {
+    std::array<BlockId, CHUNK_VOLUME> blocks;
+    std::uint64_t h = FNV_OFFSET;
+    for (const auto &chunk: column.chunks()) {
+        if (chunk) chunk->copyBlocks(blocks);
+        else blocks.fill(BlockId::Air);
+        h = hashBlocks(h, blocks);
+    }
+    return h;
+}
+
+std::uint64_t GenerationCheck::golden(TerrainGenerationMode mode, std::uint32_t seed) {
+    for (const GoldenHash &golden: GOLDEN_HASHES)
+        if (golden.mode == mode && golden.seed == seed) return golden.hash;
+    return 0;
+}
+
+std::vector<GenerationCheckResult> GenerationCheck::run(std::span<const int> threadCounts) {
+    std::vector<glm::ivec2> coords = checkedColumns();
+    std::vector<GenerationCheckResult> results;
+    ChunkColumnPool pool;
+
+    for (int m = 0; m < TERRAIN_MODES_COUNT; ++m)
+        for (std::uint32_t seed: SEEDS)
+            for (int threads: threadCounts) {
+                auto mode = static_cast<TerrainGenerationMode>(m);
+                TerrainGenerator generator(mode, seed);
+                std::vector<std::unique_ptr<ChunkColumn> > columns(coords.size());
+
+                // workers claim columns in order, so which thread generates which column varies from run to run
+                auto start = std::chrono::steady_clock::now();
+                std::atomic<std::size_t> next{0};
+                std::vector<std::jthread> workers;
+                for (int t = 0; t < threads; ++t)
+                    workers.emplace_back([&] {
+                        for (std::size_t i = next++; i < coords.size(); i = next++) {
+                            auto column = pool.acquireColumn(coords[i]);
+                            generator.generate(*column, pool, ALL_CHUNKS);
+                            generator.decorate(*column, pool, ALL_CHUNKS);
+                            columns[i] = std::move(column);
+                        }
+                    });
+                workers.clear();
+                auto generate_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+
+                std::uint64_t h = FNV_OFFSET;
+                for (auto &column: columns) {
+                    h = (h ^ hashColumn(*column)) * FNV_PRIME;
+                    pool.release(std::move(column));
+                }
+                results.push_back({
+                    mode, seed, threads, h, golden(mode, seed), coords.size(),
+                    static_cast<std::uint64_t>(generate_us)
+                });
+            }
+    return results;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "TerrainGenerator.h"
+
+namespace mc::world {
+    class ChunkColumn;
+
+    struct GenerationCheckResult {
+        TerrainGenerationMode mode;
+        std::uint32_t seed;
+        int threads;
+        std::uint64_t hash, golden;
+        std::size_t columns;
+        std::uint64_t generate_us; // wall time, hashing excluded
+
+        bool matches() const { return hash == golden; }
+
+        double columnsPerSecond() const {
+            return generate_us ? static_cast<double>(columns) * 1e6 / static_cast<double>(generate_us) : 0.0;
+        }
+    };
+
+    // generates and decorates every chunk of a fixed set of columns, near the origin and ~67k blocks out, for each
+    // mode and seed at each worker thread count, and hashes their blocks against the checked-in golden hashes.
+    // a change meant to alter the generated world updates GOLDEN_HASHES in the .cpp from the hashes it reports
+    class GenerationCheck {
+    public:
+        static constexpr std::array<std::uint32_t, 3> SEEDS = {0, 1337, 0xdeadbeef};
+
+        static std::vector<GenerationCheckResult> run(std::span<const int> threadCounts);
+
+        // 64-bit FNV-1a over the column's blocks 8 at a time, bottom chunk first, absent chunks as air
+        static std::uint64_t hashColumn(const ChunkColumn &column);
+
+        static std::uint64_t golden(TerrainGenerationMode mode, std::uint32_t seed);
+    };
+}
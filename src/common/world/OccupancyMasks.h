@@ -0,0 +1,138 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include <glm/vec3.hpp>
+
+#include "Block.h"
+#include "WorldConstants.h"
+#include "core/CopyOnWrite.h"
+
+namespace mc::world {
+    constexpr int CHUNK_ROWS = CHUNK_XYZ * CHUNK_XYZ; // one row per (y, z), bit x
+    constexpr std::uint32_t FULL_ROW = CHUNK_XYZ == 32 ? ~0u : (1u << CHUNK_XYZ) - 1;
+
+    static_assert(CHUNK_XYZ <= 32, "occupancy rows are stored in 32-bit words");
+
+    using OccupancyRows = std::span<const std::uint32_t, CHUNK_ROWS>;
+    using OccupancyPlane = std::span<const std::uint32_t, CHUNK_XYZ>;
+
+    // bit-per-voxel opaque/occluding planes, copy-on-write like the block payload
+    class OccupancyMasks {
+    public:
+        OccupancyMasks() : OccupancyMasks(BlockId::Air) {
+        }
+
+        explicit OccupancyMasks(BlockId fill) : data_(uniformData(fill)) {
+        }
+
+        static constexpr int rowIndex(int y, int z) { return y * CHUNK_XYZ + z; }
+
+        std::uint32_t opaqueRow(int y, int z) const { return data_->opaque[rowIndex(y, z)]; }
+
+        std::uint32_t occludingRow(int y, int z) const { return occluding()[rowIndex(y, z)]; }
+
+        OccupancyPlane opaquePlane(int y) const { return OccupancyPlane(opaque().data() + y * CHUNK_XYZ, CHUNK_XYZ); }
+
+        OccupancyPlane occludingPlane(int y) const {
+            return OccupancyPlane(occluding().data() + y * CHUNK_XYZ, CHUNK_XYZ);
+        }
+
+        OccupancyRows opaque() const { return OccupancyRows(data_->opaque); }
+
+        OccupancyRows occluding() const {
+            const Data &data = *data_;
+            return data.occluding.empty() ? OccupancyRows(data.opaque) : OccupancyRows(data.occluding.data(), CHUNK_ROWS);
+        }
+
+        void set(const glm::ivec3 &localCoord, Block block) {
+            int row = rowIndex(localCoord.y, localCoord.z);
+            std::uint32_t bit = 1u << localCoord.x;
+
+            const Data &current = *data_;
+            bool opaque_now = (current.opaque[row] & bit) != 0;
+            bool occluding_now = (occluding()[row] & bit) != 0;
+            if (opaque_now == block.opaque() && occluding_now == block.occluding()) return;
+
+            if (!core::soleOwner(data_)) data_ = std::make_shared<Data>(*data_); // copy on first write
+            Data &data = *data_;
+
+            // occluding plane only diverges from opaque once a cutout block shows up
+            if (data.occluding.empty() && block.opaque() != block.occluding())
+                data.occluding.assign(data.opaque.begin(), data.opaque.end());
+
+            data.opaque[row] = block.opaque() ? data.opaque[row] | bit : data.opaque[row] & ~bit;
+            if (!data.occluding.empty())
+                data.occluding[row] = block.occluding() ? data.occluding[row] | bit : data.occluding[row] & ~bit;
+        }
+
+        // rebuilds both planes from a full chunk of ids in (y, z, x) order
+        void assign(std::span<const BlockId, CHUNK_XYZ * CHUNK_XYZ * CHUNK_XYZ> blocks) {
+            if (!core::soleOwner(data_)) data_ = std::make_shared<Data>();
+            Data &data = *data_;
+            data.occluding.clear();
+
+            bool has_cutout = false;
+            for (int row = 0; row < CHUNK_ROWS; ++row) {
+                std::uint32_t opaque = 0, occluding = 0;
+                for (int x = 0; x < CHUNK_XYZ; ++x) {
+                    Block block{blocks[row * CHUNK_XYZ + x]};
+                    opaque |= static_cast<std::uint32_t>(block.opaque()) << x;
+                    occluding |= static_cast<std::uint32_t>(block.occluding()) << x;
+                }
+                data.opaque[row] = opaque;
+                if (opaque != occluding && !has_cutout) {
+                    has_cutout = true;
+                    data.occluding.assign(data.opaque.begin(), data.opaque.begin() + row);
+                    data.occluding.resize(CHUNK_ROWS);
+                }
+                if (has_cutout) data.occluding[row] = occluding;
+            }
+        }
+
+        void clear() {
+            if (!core::soleOwner(data_)) {
+                data_ = uniformData(BlockId::Air);
+                return;
+            }
+            data_->opaque.fill(0u);
+            data_->occluding.clear();
+        }
+
+        std::size_t memoryUsage() const {
+            if (isShared()) return sizeof(*this);
+            return sizeof(*this) + sizeof(Data) + data_->occluding.capacity() * sizeof(std::uint32_t);
+        }
+
+    private:
+        struct Data {
+            std::array<std::uint32_t, CHUNK_ROWS> opaque{};
+            std::vector<std::uint32_t> occluding; // empty while it equals opaque
+        };
+
+        std::shared_ptr<Data> data_;
+
+        bool isShared() const {
+            for (std::size_t i = 0; i < NUM_BLOCKS; ++i)
+                if (data_ == uniformData(static_cast<BlockId>(i))) return true;
+            return false;
+        }
+
+        static const std::shared_ptr<Data> &uniformData(BlockId blockId) {
+            static const std::array<std::shared_ptr<Data>, NUM_BLOCKS> datas = [] {
+                std::array<std::shared_ptr<Data>, NUM_BLOCKS> out;
+                for (std::size_t i = 0; i < NUM_BLOCKS; ++i) {
+                    Block block{static_cast<BlockId>(i)};
+                    out[i] = std::make_shared<Data>();
+                    out[i]->opaque.fill(block.opaque() ? FULL_ROW : 0u);
+                    if (block.opaque() != block.occluding())
+                        out[i]->occluding.assign(CHUNK_ROWS, block.occluding() ? FULL_ROW : 0u);
+                }
+                return out;
+            }();
+            return datas[static_cast<std::uint8_t>(blockId)];
+        }
+    };
+}
@@ -0,0 +1,94 @@
+#include "PerlinNoise.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define MC_TARGET_AVX2
+#else
+#define MC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#define MC_HAS_AVX2_PATH 1
+#endif
+
+using namespace mc::world;
+
+namespace {
+#ifdef MC_HAS_AVX2_PATH
+    bool cpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(info, 7, 0);
+        return os_saves_ymm && (info[1] & (1 << 5));
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    MC_TARGET_AVX2 __m256 fade8(__m256 t) {
+        __m256 three_minus_2t = _mm256_sub_ps(_mm256_set1_ps(3.f), _mm256_mul_ps(_mm256_set1_ps(2.f), t));
+        return _mm256_mul_ps(_mm256_mul_ps(t, t), three_minus_2t);
+    }
+
+    MC_TARGET_AVX2 __m256 lerp8(__m256 a, __m256 b, __m256 t) {
+        return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+    }
+
+    // GRAD[h & 3]: bit 0 negates the x weight (1), bit 1 the y weight (2)
+    MC_TARGET_AVX2 __m256 grad8(__m256i h, __m256 x, __m256 y) {
+        __m256 gx = _mm256_or_ps(_mm256_set1_ps(1.f), _mm256_castsi256_ps(_mm256_slli_epi32(h, 31)));
+        __m256 gy = _mm256_or_ps(_mm256_set1_ps(2.f),
+                                 _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_srli_epi32(h, 1), 31)));
+        return _mm256_add_ps(_mm256_mul_ps(gx, x), _mm256_mul_ps(gy, y));
+    }
+
+    // the PerlinNoise::noise steps lane by lane; y is shared by the row, so its part is scalar
+    MC_TARGET_AVX2 int noiseRowAvx2(const int *perm, float *out, float x0, float y, float dx, int n) {
+        float fy = floorf(y);
+        __m256i Y = _mm256_set1_epi32(static_cast<int>(fy) & 255);
+        float yf = y - fy;
+        __m256 v = _mm256_set1_ps(yf * yf * (3.f - 2.f * yf));
+        __m256 y0 = _mm256_set1_ps(yf);
+        __m256 y1 = _mm256_set1_ps(yf - 1);
+
+        const __m256 one = _mm256_set1_ps(1.f);
+        const __m256i byte_mask = _mm256_set1_epi32(255);
+        const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+        int i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256 index = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32(i), lane));
+            __m256 x = _mm256_add_ps(_mm256_set1_ps(x0), _mm256_mul_ps(index, _mm256_set1_ps(dx)));
+
+            __m256 fx = _mm256_floor_ps(x);
+            __m256i X = _mm256_and_si256(_mm256_cvttps_epi32(fx), byte_mask);
+            __m256 xf = _mm256_sub_ps(x, fx);
+            __m256 u = fade8(xf);
+
+            __m256i X1 = _mm256_add_epi32(X, _mm256_set1_epi32(1));
+            __m256i aa = _mm256_i32gather_epi32(perm, _mm256_and_si256(_mm256_add_epi32(X, Y), byte_mask), 4);
+            __m256i ba = _mm256_i32gather_epi32(perm, _mm256_and_si256(_mm256_add_epi32(X1, Y), byte_mask), 4);
+            __m256i Y1 = _mm256_add_epi32(Y, _mm256_set1_epi32(1));
+            __m256i ab = _mm256_i32gather_epi32(perm, _mm256_and_si256(_mm256_add_epi32(X, Y1), byte_mask), 4);
+            __m256i bb = _mm256_i32gather_epi32(perm, _mm256_and_si256(_mm256_add_epi32(X1, Y1), byte_mask), 4);
+
+            __m256 x1 = _mm256_sub_ps(xf, one);
+            __m256 lerp1 = lerp8(grad8(aa, xf, y0), grad8(ba, x1, y0), u);
+            __m256 lerp2 = lerp8(grad8(ab, xf, y1), grad8(bb, x1, y1), u);
+            _mm256_storeu_ps(out + i, lerp8(lerp1, lerp2, v));
+        }
+        return i;
+    }
+#endif
+}
+
+void PerlinNoise::noiseRow(float *out, float x0, float y, float dx, int n) const {
+    int i = 0;
+#ifdef MC_HAS_AVX2_PATH
+    static const bool has_avx2 = cpuHasAvx2();
+    if (has_avx2) i = noiseRowAvx2(p_.data(), out, x0, y, dx, n);
+#endif
+    for (; i < n; ++i) out[i] = noise(x0 + static_cast<float>(i) * dx, y);
+}
@@ -0,0 +1,126 @@
+#include <stdexcept>
+
+#include "RegionFile.h"
+#include "core/FileSync.h"
+
+using namespace mc::world;
+
+namespace {
+    void putU32(std::uint8_t *out, std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) out[i] = static_cast<std::uint8_t>(v >> (8 * i));
+    }
+
+    std::uint32_t getU32(const std::uint8_t *in) {
+        std::uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= static_cast<std::uint32_t>(in[i]) << (8 * i);
+        return v;
+    }
+}
+
+RegionFile::RegionFile(const std::filesystem::path &path) : path_(path) {
+    if (!std::filesystem::exists(path)) {
+        std::ofstream create(path, std::ios::binary);
+        std::vector<char> header(HEADER_BYTES, 0);
+        create.write(header.data(), static_cast<std::streamsize>(header.size()));
+        create.close();
+        // the first write syncs the file itself, its directory entry has to be there to find it
+        if (!create || !core::syncDirectory(path.parent_path()))
+            throw std::runtime_error("Failed to create region file " + path.string());
+    }
+
+    file_.open(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file_) throw std::runtime_error("Failed to open region file " + path.string());
+
+    std::vector<std::uint8_t> header(HEADER_BYTES);
+    file_.read(reinterpret_cast<char *>(header.data()), static_cast<std::streamsize>(header.size()));
+    if (!file_) throw std::runtime_error("Corrupt region file header " + path.string());
+
+    for (int i = 0; i < REGION_COLUMNS; ++i) {
+        Entry &entry = entries_[i];
+        entry.sector = getU32(header.data() + i * 8);
+        entry.bytes = getU32(header.data() + i * 8 + 4);
+        if (entry.sector != 0)
+            sector_count_ = std::max(sector_count_, entry.sector + sectorsFor(entry.bytes));
+    }
+
+    used_sectors_.assign(sector_count_, false);
+    std::fill_n(used_sectors_.begin(), HEADER_SECTORS, true);
+    for (const Entry &entry: entries_)
+        if (entry.sector != 0) markSectors(entry, true);
+}
+
+bool RegionFile::contains(const glm::ivec2 &columnCoord) const {
+    std::lock_guard lock(mutex_);
+    return entries_[slot(columnCoord)].sector != 0;
+}
+
+std::optional<std::vector<std::uint8_t> > RegionFile::read(const glm::ivec2 &columnCoord) {
+    std::lock_guard lock(mutex_);
+    const Entry &entry = entries_[slot(columnCoord)];
+    if (entry.sector == 0) return std::nullopt;
+
+    std::vector<std::uint8_t> payload(entry.bytes);
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(entry.sector) * SECTOR_BYTES);
+    file_.read(reinterpret_cast<char *>(payload.data()), static_cast<std::streamsize>(payload.size()));
+    if (!file_) {
+        file_.clear();
+        return std::nullopt;
+    }
+    return payload;
+}
+
+void RegionFile::write(const glm::ivec2 &columnCoord, const std::vector<std::uint8_t> &payload) {
+    std::lock_guard lock(mutex_);
+    int index = slot(columnCoord);
+    Entry &entry = entries_[index];
+
+    std::uint32_t sectors = sectorsFor(payload.size());
+    std::uint32_t sector = allocate(sectors);
+
+    // payload on the disk before its offset table entry, so a new payload is never referenced half-written
+    std::vector<char> padded(static_cast<std::size_t>(sectors) * SECTOR_BYTES, 0);
+    std::copy(payload.begin(), payload.end(), padded.begin());
+    file_.clear();
+    file_.seekp(static_cast<std::streamoff>(sector) * SECTOR_BYTES);
+    file_.write(padded.data(), static_cast<std::streamsize>(padded.size()));
+    file_.flush();
+    if (!file_ || !core::syncFile(path_))
+        throw std::runtime_error("Failed to write region file " + path_.string());
+
+    Entry previous = entry;
+    entry = {sector, static_cast<std::uint32_t>(payload.size())};
+    markSectors(entry, true);
+    writeEntry(index);
+    // until the entry is on the disk it may still point at the old sectors, which stay in use till then
+    if (!file_ || !core::syncFile(path_))
+        throw std::runtime_error("Failed to write region file " + path_.string());
+    if (previous.sector != 0) markSectors(previous, false);
+}
+
+void RegionFile::writeEntry(int slot) {
+    std::uint8_t bytes[8];
+    putU32(bytes, entries_[slot].sector);
+    putU32(bytes + 4, entries_[slot].bytes);
+    file_.seekp(static_cast<std::streamoff>(slot) * sizeof(bytes));
+    file_.write(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+    file_.flush();
+}
+
+std::uint32_t RegionFile::allocate(std::uint32_t sectors) {
+    std::uint32_t run = 0;
+    for (std::uint32_t sector = HEADER_SECTORS; sector < sector_count_; ++sector) {
+        run = used_sectors_[sector] ? 0 : run + 1;
+        if (run == sectors) return sector + 1 - sectors;
+    }
+
+    // extend whatever free run ends the file
+    std::uint32_t first = sector_count_ - run;
+    sector_count_ = first + sectors;
+    used_sectors_.resize(sector_count_, false);
+    return first;
+}
+
+void RegionFile::markSectors(const Entry &entry, bool used) {
+    std::fill_n(used_sectors_.begin() + entry.sector, sectorsFor(entry.bytes), used);
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <glm/vec2.hpp>
+
+namespace mc::world {
+    constexpr int REGION_BITS = 5; // 32x32 columns per region file
+    constexpr int REGION_XZ = 1 << REGION_BITS;
+    constexpr int REGION_MASK = REGION_XZ - 1;
+    constexpr int REGION_COLUMNS = REGION_XZ * REGION_XZ;
+
+    // region file layout, every block aligned to SECTOR_BYTES so it can be mmapped as is:
+    //   sectors 0-1: offset table, per column {u32 first sector, u32 payload bytes}, 0 sectors = absent
+    //   sectors 2..: per column payloads, each starting on a sector boundary
+    // a rewrite goes to free sectors, syncs them and only then repoints the offset table entry, whose old sectors
+    // are free again once the entry is synced too; a crash or power loss leaves either the old or the new payload,
+    // never a mix of both. a write that returns is on the disk, one that throws may have left either
+    class RegionFile {
+    public:
+        static constexpr std::size_t SECTOR_BYTES = 4096;
+        static constexpr std::size_t HEADER_BYTES = REGION_COLUMNS * 2 * sizeof(std::uint32_t);
+        static constexpr std::uint32_t HEADER_SECTORS = HEADER_BYTES / SECTOR_BYTES;
+
+        explicit RegionFile(const std::filesystem::path &path);
+
+        RegionFile(const RegionFile &) = delete;
+
+        RegionFile &operator=(const RegionFile &) = delete;
+
+        bool contains(const glm::ivec2 &columnCoord) const;
+
+        std::optional<std::vector<std::uint8_t> > read(const glm::ivec2 &columnCoord);
+
+        // syncs the payload and its offset table entry to the disk, throws when either fails
+        void write(const glm::ivec2 &columnCoord, const std::vector<std::uint8_t> &payload);
+
+        static glm::ivec2 regionOf(const glm::ivec2 &columnCoord) {
+            return {columnCoord.x >> REGION_BITS, columnCoord.y >> REGION_BITS};
+        }
+
+    private:
+        struct Entry {
+            std::uint32_t sector = 0;
+            std::uint32_t bytes = 0;
+        };
+
+        mutable std::mutex mutex_;
+        std::filesystem::path path_;
+        std::fstream file_;
+        std::array<Entry, REGION_COLUMNS> entries_{};
+        std::uint32_t sector_count_ = HEADER_SECTORS;
+        std::vector<bool> used_sectors_;
+
+        static int slot(const glm::ivec2 &columnCoord) {
+            return (columnCoord.y & REGION_MASK) * REGION_XZ + (columnCoord.x & REGION_MASK);
+        }
+
+        static std::uint32_t sectorsFor(std::size_t bytes) {
+            return static_cast<std::uint32_t>((bytes + SECTOR_BYTES - 1) / SECTOR_BYTES);
+        }
+
+        void writeEntry(int slot);
+
+        // first run of free sectors long enough, or the end of the file
+        std::uint32_t allocate(std::uint32_t sectors);
+
+        void markSectors(const Entry &entry, bool used);
+    };
+}
@@ -0,0 +1,100 @@
+#include <string>
+
+#include "RegionStore.h"
+
+using namespace mc::world;
+
+RegionStore::RegionStore(std::filesystem::path directory) : directory_(std::move(directory)) {
+    std::filesystem::create_directories(directory_);
+}
+
+std::optional<std::vector<std::uint8_t> > RegionStore::read(const glm::ivec2 &columnCoord) {
+    RegionFile *file = regionFile(columnCoord, false);
+    if (!file) return std::nullopt;
+    return file->read(columnCoord);
+}
+
+StoredColumn RegionStore::readColumn(const glm::ivec2 &columnCoord) {
+    std::vector<BlockEdit> column_edits = edits(columnCoord);
+    return {read(columnCoord), std::move(column_edits)};
+}
+
+void RegionStore::write(const glm::ivec2 &columnCoord, const std::vector<std::uint8_t> &payload) {
+    regionFile(columnCoord, true)->write(columnCoord, payload);
+}
+
+std::vector<BlockEdit> RegionStore::edits(const glm::ivec2 &columnCoord) {
+    EditJournal *edit_journal = journal(columnCoord, false);
+    if (!edit_journal) return {};
+    return edit_journal->edits(columnCoord);
+}
+
+std::size_t RegionStore::editCount(const glm::ivec2 &columnCoord, ChunkMask chunkMask) {
+    EditJournal *edit_journal = journal(columnCoord, false);
+    return edit_journal ? edit_journal->editCount(columnCoord, chunkMask) : 0;
+}
+
+std::uint64_t RegionStore::journalMark(const glm::ivec2 &columnCoord) {
+    EditJournal *edit_journal = journal(columnCoord, false);
+    return edit_journal ? edit_journal->mark() : 0;
+}
+
+void RegionStore::appendEdit(const glm::ivec2 &columnCoord, const BlockEdit &edit) {
+    journal(columnCoord, true)->append(columnCoord, edit);
+}
+
+void RegionStore::dropEdits(const glm::ivec2 &columnCoord, ChunkMask chunkMask, std::uint64_t before) {
+    if (EditJournal *edit_journal = journal(columnCoord, false))
+        edit_journal->drop(columnCoord, chunkMask, before);
+}
+
+void RegionStore::syncJournals() {
+    // regions are never closed before the store, so the journals outlive the lock
+    std::vector<EditJournal *> journals;
+    {
+        std::lock_guard lock(mutex_);
+        for (auto &[region_coord, region]: regions_)
+            if (region.journal) journals.push_back(region.journal.get());
+    }
+    for (EditJournal *edit_journal: journals) edit_journal->sync();
+}
+
+RegionFile *RegionStore::regionFile(const glm::ivec2 &columnCoord, bool create) {
+    glm::ivec2 region_coord = RegionFile::regionOf(columnCoord);
+
+    std::lock_guard lock(mutex_);
+    Region &region = regions_[region_coord];
+    if (region.file) return region.file.get();
+    if (!create && region.file_missing) return nullptr;
+
+    std::filesystem::path path = regionPath(region_coord, ".mcr");
+    if (!create && !std::filesystem::exists(path)) {
+        region.file_missing = true;
+        return nullptr;
+    }
+
+    region.file = std::make_unique<RegionFile>(path);
+    return region.file.get();
+}
+
+EditJournal *RegionStore::journal(const glm::ivec2 &columnCoord, bool create) {
+    glm::ivec2 region_coord = RegionFile::regionOf(columnCoord);
+
+    std::lock_guard lock(mutex_);
+    Region &region = regions_[region_coord];
+    if (region.journal) return region.journal.get();
+    if (!create && region.journal_missing) return nullptr;
+
+    std::filesystem::path path = regionPath(region_coord, ".mcj");
+    if (!create && !std::filesystem::exists(path)) {
+        region.journal_missing = true;
+        return nullptr;
+    }
+
+    region.journal = std::make_unique<EditJournal>(path);
+    return region.journal.get();
+}
+
+std::filesystem::path RegionStore::regionPath(const glm::ivec2 &regionCoord, const char *extension) const {
+    return directory_ / ("r." + std::to_string(regionCoord.x) + "." + std::to_string(regionCoord.y) + extension);
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <glm/vec2.hpp>
+
+#include "EditJournal.h"
+#include "RegionFile.h"
+#include "WorldConstants.h"
+
+namespace mc::world {
+    // everything a column needs from disk: its region file snapshot (if any) and its journaled edits
+    struct StoredColumn {
+        std::optional<std::vector<std::uint8_t> > snapshot;
+        std::vector<BlockEdit> edits;
+    };
+
+    // directory of region files and their edit journals, opened lazily; safe to use from generation workers
+    class RegionStore {
+    public:
+        explicit RegionStore(std::filesystem::path directory);
+
+        std::optional<std::vector<std::uint8_t> > read(const glm::ivec2 &columnCoord);
+
+        // edits first, then the snapshot: a save writes its snapshot before dropping the edits it covers, so a
+        // read racing it sees the old snapshot with every edit or the new one with at least the edits it lacks
+        StoredColumn readColumn(const glm::ivec2 &columnCoord);
+
+        void write(const glm::ivec2 &columnCoord, const std::vector<std::uint8_t> &payload);
+
+        std::vector<BlockEdit> edits(const glm::ivec2 &columnCoord);
+
+        std::size_t editCount(const glm::ivec2 &columnCoord, ChunkMask chunkMask = ALL_CHUNKS);
+
+        // see EditJournal::mark
+        std::uint64_t journalMark(const glm::ivec2 &columnCoord);
+
+        void appendEdit(const glm::ivec2 &columnCoord, const BlockEdit &edit);
+
+        void dropEdits(const glm::ivec2 &columnCoord, ChunkMask chunkMask = ALL_CHUNKS,
+                       std::uint64_t before = std::numeric_limits<std::uint64_t>::max());
+
+        // EditJournal::sync on every open journal, without holding up the store while the disk is waited on
+        void syncJournals();
+
+        const std::filesystem::path &directory() const { return directory_; }
+
+    private:
+        // a file looked for and not found is not looked for again, only this store creates them
+        struct Region {
+            std::unique_ptr<RegionFile> file;
+            std::unique_ptr<EditJournal> journal;
+            bool file_missing = false, journal_missing = false;
+        };
+
+        std::filesystem::path directory_;
+        std::mutex mutex_;
+        std::unordered_map<glm::ivec2, Region, ColumnHash> regions_;
+
+        RegionFile *regionFile(const glm::ivec2 &columnCoord, bool create);
+
+        EditJournal *journal(const glm::ivec2 &columnCoord, bool create);
+
+        std::filesystem::path regionPath(const glm::ivec2 &regionCoord, const char *extension) const;
+    };
+}
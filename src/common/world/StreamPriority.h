@@ -0,0 +1,67 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <utility>
+#include <glm/glm.hpp>
+
+#include "WorldConstants.h"
+#include "core/Frustum.h"
+
+namespace mc::world {
+    // the order streaming works through columns around the camera, smaller scores first: distance in columns,
+    // shortened along the heading and stretched for columns outside the view frustum, so what the player sees
+    // and flies into loads and meshes before what is behind them. the column the camera is in goes first of all
+    class StreamPriority {
+    public:
+        // an unseen column waits as long as a visible one this many times as far
+        static constexpr float OUT_OF_VIEW_FACTOR = 3.f;
+        // a column straight ahead counts as 1 - HEADING_WEIGHT of its distance, one straight behind as 1 + it
+        static constexpr float HEADING_WEIGHT = 0.5f;
+        // blocks per second below which there is no heading
+        static constexpr float MIN_HEADING_SPEED = 1.f;
+        // below any distance, however shortened by the heading
+        static constexpr float CAMERA_COLUMN_SCORE = -1.f;
+
+        // distance from the origin alone
+        StreamPriority() = default;
+
+        // velocity in blocks per second (xz); the frustum is tested against each column's vertical render window
+        // around centreChunkY
+        StreamPriority(const glm::vec3 &position, const glm::vec2 &velocity, std::optional<core::Frustum> frustum,
+                       int centreChunkY)
+            : position_{position.x, position.z}, frustum_{std::move(frustum)},
+              min_y_{(centreChunkY - VERTICAL_RENDER_RADIUS) * CHUNK_XYZ},
+              max_y_{(centreChunkY + VERTICAL_RENDER_RADIUS + 1) * CHUNK_XYZ} {
+            float speed = glm::length(velocity);
+            if (speed >= MIN_HEADING_SPEED) heading_ = velocity / speed;
+        }
+
+        // never negative, but for the camera's own column
+        float operator()(const glm::ivec2 &columnCoord) const {
+            // whichever way the camera looks or flies
+            glm::ivec2 camera_column(glm::floor(position_ / static_cast<float>(CHUNK_XYZ)));
+            if (columnCoord == camera_column) return CAMERA_COLUMN_SCORE;
+
+            glm::vec2 to_column = (glm::vec2(columnCoord) + 0.5f) * static_cast<float>(CHUNK_XYZ) - position_;
+            float distance = glm::length(to_column) / static_cast<float>(CHUNK_XYZ);
+
+            float score = distance * (1.f - HEADING_WEIGHT * glm::dot(to_column, heading_) /
+                                             (distance * static_cast<float>(CHUNK_XYZ)));
+            if (frustum_) {
+                glm::ivec3 box_min(columnCoord.x * CHUNK_XYZ, min_y_, columnCoord.y * CHUNK_XYZ);
+                glm::ivec3 box_max(box_min.x + CHUNK_XYZ, max_y_, box_min.z + CHUNK_XYZ);
+                if (!frustum_->intersectsAABB(box_min, box_max)) score *= OUT_OF_VIEW_FACTOR;
+            }
+            return score;
+        }
+
+        const glm::vec2 &heading() const { return heading_; }
+
+    private:
+        glm::vec2 position_{0.f};
+        glm::vec2 heading_{0.f};
+        std::optional<core::Frustum> frustum_;
+        int min_y_ = 0, max_y_ = 0;
+    };
+}
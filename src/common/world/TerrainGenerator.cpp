@@ -0,0 +1,41 @@
+#include <vector>
+
+#include "TerrainGenerator.h"
+#include "ChunkColumn.h"
+#include "TreeFeature.h"
+
+using namespace mc::world;
+
+void TerrainGenerator::generate(ChunkColumn &column, ChunkColumnPool &pool, ChunkMask mask) const {
+    switch (mode_) {
+        case TerrainGenerationMode::SineWave:
+            column.generateTerrain([this](int wx, int wz) { return sineHeight(wx, wz); }, pool, mask);
+            break;
+        case TerrainGenerationMode::PerlinNoise:
+            column.generateTerrain([this](int wx0, int wz, std::span<std::int16_t, CHUNK_XYZ> heights) {
+                perlinHeights(wx0, wz, heights);
+            }, pool, mask);
+            break;
+        case TerrainGenerationMode::Density3D:
+            column.generateDensityTerrain(density_field_, pool, mask);
+            break;
+    }
+}
+
+void TerrainGenerator::decorate(ChunkColumn &column, ChunkColumnPool &pool, ChunkMask mask) const {
+    // density terrain has no heightmap to root trees on
+    if (!column.hasHeightmap()) return;
+
+    glm::ivec2 origin = column.coord() * CHUNK_XYZ;
+    auto treesOn = [&](auto &&heightAt) {
+        return TreeFeature::place(column.coord(), seed_, [&](int wx, int wz) {
+            int x = wx - origin.x, z = wz - origin.y;
+            bool inside = x >= 0 && x < CHUNK_XYZ && z >= 0 && z < CHUNK_XYZ;
+            return inside ? column.surfaceHeight(x, z) : heightAt(wx, wz);
+        });
+    };
+    std::vector<Tree> trees = mode_ == TerrainGenerationMode::SineWave
+                                  ? treesOn([this](int wx, int wz) { return sineHeight(wx, wz); })
+                                  : treesOn([this](int wx, int wz) { return perlinHeight(wx, wz); });
+    TreeFeature::draw(trees, column, pool, mask);
+}
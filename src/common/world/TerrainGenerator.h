@@ -0,0 +1,93 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+
+#include "DensityField.h"
+#include "PerlinNoise.h"
+#include "WorldConstants.h"
+
+namespace mc::world {
+    class ChunkColumn;
+    class ChunkColumnPool;
+
+    enum class TerrainGenerationMode {
+        SineWave,
+        PerlinNoise,
+        Density3D
+    };
+
+    constexpr int TERRAIN_MODES_COUNT = 3;
+
+    constexpr const char *terrainModeName(TerrainGenerationMode mode) {
+        switch (mode) {
+            case TerrainGenerationMode::SineWave: return "sine";
+            case TerrainGenerationMode::PerlinNoise: return "perlin";
+            case TerrainGenerationMode::Density3D: return "density";
+        }
+        return "unknown";
+    }
+
+    // a pure function of mode and seed: a chunk comes out the same whichever thread generates it and whatever
+    // was generated before it, which GenerationCheck holds it to
+    class TerrainGenerator {
+    public:
+        explicit TerrainGenerator(TerrainGenerationMode mode = TerrainGenerationMode::SineWave,
+                                  std::uint32_t seed = 0)
+            : mode_{mode}, seed_{seed}, perlin_noise_{seed}, density_field_{seed} {
+        }
+
+        TerrainGenerationMode mode() const { return mode_; }
+        std::uint32_t seed() const { return seed_; }
+
+        // base terrain and its surface layers for the chunks in mask
+        void generate(ChunkColumn &column, ChunkColumnPool &pool, ChunkMask mask) const;
+
+        // draws the trees reaching into the chunks of mask, rooted on the heightmap generate() left behind
+        void decorate(ChunkColumn &column, ChunkColumnPool &pool, ChunkMask mask) const;
+
+    private:
+        TerrainGenerationMode mode_;
+        std::uint32_t seed_;
+        PerlinNoise perlin_noise_;
+        DensityField density_field_;
+
+        int sineHeight(int wx, int wz,
+                       int base = 64,
+                       int amplitude = 48) const {
+            constexpr float INV_64_TAU = 1.f / 64.f * 6.283185f;
+
+            int seed = static_cast<int>(seed_);
+            float sx = std::sinf((wx + seed) * INV_64_TAU);
+            float cz = std::cosf((wz + seed) * INV_64_TAU);
+            float h = base + amplitude * (sx + cz) / 2.f;
+            return std::clamp(static_cast<int>(h), MIN_WORLD_Y, MAX_WORLD_Y);
+        }
+
+        // the single sample perlinHeights would take for wx, noise() and noiseRow() agree bit for bit
+        int perlinHeight(int wx, int wz,
+                         int base = 80,
+                         int amplitude = 80,
+                         float scale = 32.f) const {
+            float h_f = perlin_noise_.noise(static_cast<float>(wx) / scale, static_cast<float>(wz) / scale);
+            return std::clamp(base + static_cast<int>(h_f * amplitude), MIN_WORLD_Y, MAX_WORLD_Y);
+        }
+
+        // one heightmap row from wx0 in a single noiseRow call; with a power of two scale the samples are
+        // exactly wx / scale, as a per-sample noise() call would take them
+        void perlinHeights(int wx0, int wz, std::span<std::int16_t, CHUNK_XYZ> heights,
+                           int base = 80,
+                           int amplitude = 80,
+                           float scale = 32.f) const {
+            std::array<float, CHUNK_XYZ> h_f;
+            perlin_noise_.noiseRow(h_f.data(), static_cast<float>(wx0) / scale, static_cast<float>(wz) / scale,
+                                   1.f / scale, CHUNK_XYZ);
+            for (int x = 0; x < CHUNK_XYZ; ++x) {
+                int h = base + static_cast<int>(h_f[x] * amplitude);
+                heights[x] = static_cast<std::int16_t>(std::clamp(h, MIN_WORLD_Y, MAX_WORLD_Y));
+            }
+        }
+    };
+}
@@ -0,0 +1,66 @@
+#include <cstdlib>
+
+#include "TreeFeature.h"
+#include "ChunkColumn.h"
+#include "ChunkColumnPool.h"
+
+using namespace mc::world;
+
+namespace {
+    constexpr std::uint32_t TREE_CHANCE_PERCENT = 45;
+
+    std::uint32_t hashCell(int cellX, int cellZ, std::uint32_t seed) {
+        std::uint32_t h = seed ^ static_cast<std::uint32_t>(cellX) * 0x27d4eb2du ^
+                          static_cast<std::uint32_t>(cellZ) * 0x165667b1u;
+        h ^= h >> 15;
+        h *= 0x2c1b3c6du;
+        h ^= h >> 12;
+        h *= 0x297a2d39u;
+        h ^= h >> 15;
+        return h;
+    }
+}
+
+std::optional<Tree> TreeFeature::treeIn(int cellX, int cellZ, std::uint32_t seed) {
+    std::uint32_t h = hashCell(cellX, cellZ, seed);
+    if (h % 100 >= TREE_CHANCE_PERCENT) return std::nullopt;
+
+    // spots 1..CELL-2 into the cell keep trunks of neighbouring cells at least 3 blocks apart
+    int x = (cellX << CELL_BITS) + 1 + static_cast<int>((h >> 8) % (CELL - 2));
+    int z = (cellZ << CELL_BITS) + 1 + static_cast<int>((h >> 16) % (CELL - 2));
+    int trunk_height = MAX_TRUNK_HEIGHT - 2 + static_cast<int>((h >> 24) % 3);
+    return Tree{{x, 0, z}, trunk_height};
+}
+
+void TreeFeature::draw(std::span<const Tree> trees, ChunkColumn &column, ChunkColumnPool &pool, ChunkMask mask) {
+    glm::ivec2 origin = column.coord() * CHUNK_XYZ;
+
+    auto place = [&](const glm::ivec3 &worldCoord, BlockId blockId, bool intoAirOnly) {
+        glm::ivec3 local(worldCoord.x - origin.x, worldCoord.y, worldCoord.z - origin.y);
+        if (local.x < 0 || local.x >= CHUNK_XYZ || local.z < 0 || local.z >= CHUNK_XYZ) return;
+        int index = local.y >> CHUNK_BITS;
+        if (!((mask >> index) & 1u)) return;
+
+        auto &chunk = column.chunks()[index];
+        glm::ivec3 local_coord(local.x, local.y & CHUNK_MASK, local.z);
+        if (!chunk) chunk = pool.acquireChunk({column.coord().x, index, column.coord().y});
+        else if (intoAirOnly && chunk->blockAt(local_coord).id != BlockId::Air) return;
+        chunk->setBlock(local_coord, blockId);
+    };
+
+    for (const Tree &tree: trees)
+        for (int y = 1; y <= tree.trunk_height; ++y) place(tree.root + glm::ivec3(0, y, 0), BlockId::Wood, false);
+
+    // two wide layers around the top of the trunk, then two narrow ones, corners left out
+    for (const Tree &tree: trees) {
+        glm::ivec3 top = tree.root + glm::ivec3(0, tree.trunk_height, 0);
+        for (int dy = -2; dy <= 1; ++dy) {
+            int radius = dy < 0 ? REACH : REACH - 1;
+            for (int dz = -radius; dz <= radius; ++dz)
+                for (int dx = -radius; dx <= radius; ++dx) {
+                    if (std::abs(dx) == radius && std::abs(dz) == radius) continue;
+                    place(top + glm::ivec3(dx, dy, dz), BlockId::Leaves, true);
+                }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include "WorldConstants.h"
+
+namespace mc::world {
+    class ChunkColumn;
+    class ChunkColumnPool;
+
+    struct Tree {
+        glm::ivec3 root; // the surface block the trunk stands on, in world coordinates
+        int trunk_height;
+    };
+
+    // at most one tree per CELL x CELL area, at a spot hashed from the cell and the seed. a column draws every
+    // tree whose canopy reaches into it, its neighbours' included, so trees cross column borders without a
+    // column ever writing into another, and come out the same whichever chunks or columns are generated first
+    class TreeFeature {
+    public:
+        static constexpr int CELL_BITS = 3;
+        static constexpr int CELL = 1 << CELL_BITS;
+        static constexpr int REACH = 2; // canopy radius around the trunk
+        static constexpr int MAX_TRUNK_HEIGHT = 6;
+
+        // the trees that reach the column at columnCoord; surfaceHeight(wx, wz) is the y a trunk at wx, wz
+        // stands on, also for spots in the neighbouring columns
+        template<typename SurfaceHeightFn>
+        static std::vector<Tree> place(const glm::ivec2 &columnCoord, std::uint32_t seed,
+                                       SurfaceHeightFn &&surfaceHeight) {
+            glm::ivec2 min = columnCoord * CHUNK_XYZ - REACH;
+            glm::ivec2 max = columnCoord * CHUNK_XYZ + (CHUNK_XYZ - 1 + REACH);
+
+            std::vector<Tree> trees;
+            for (int cell_z = min.y >> CELL_BITS; cell_z <= max.y >> CELL_BITS; ++cell_z)
+                for (int cell_x = min.x >> CELL_BITS; cell_x <= max.x >> CELL_BITS; ++cell_x) {
+                    std::optional<Tree> tree = treeIn(cell_x, cell_z, seed);
+                    if (!tree) continue;
+                    glm::ivec2 spot(tree->root.x, tree->root.z);
+                    if (spot.x < min.x || spot.y < min.y || spot.x > max.x || spot.y > max.y) continue;
+
+                    tree->root.y = surfaceHeight(spot.x, spot.y);
+                    if (tree->root.y <= MIN_WORLD_Y || tree->root.y + tree->trunk_height + 1 > MAX_WORLD_Y) continue;
+                    trees.push_back(*tree);
+                }
+            return trees;
+        }
+
+        // trunks, then leaves into whatever is still air, limited to the chunks of mask
+        static void draw(std::span<const Tree> trees, ChunkColumn &column, ChunkColumnPool &pool, ChunkMask mask);
+
+    private:
+        // the cell's tree without its root height, if it has one
+        static std::optional<Tree> treeIn(int cellX, int cellZ, std::uint32_t seed);
+    };
+}
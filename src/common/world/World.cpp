@@ -0,0 +1,511 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <ranges>
+#include <string>
+#include <utility>
+
+#include "World.h"
+#include "ColumnCodec.h"
+
+using namespace mc::world;
+
+namespace {
+    std::uint64_t elapsedMicroseconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+void World::streamChunkColumns(const glm::ivec3 &centreChunk, const glm::vec2 &velocity) {
+    glm::ivec2 centre(centreChunk.x, centreChunk.z);
+    if (centre == last_stream_centre_ && centreChunk.y == last_stream_centre_y_) {
+        streamVertically();
+        return;
+    }
+    bool moved_vertically = centreChunk.y != last_stream_centre_y_;
+    last_stream_centre_ = centre;
+    last_stream_centre_y_ = centreChunk.y;
+
+    releaseColumns([&](const glm::ivec2 &columnCoord) { return !inLoadRadius(columnCoord); }, true);
+    cancelLoads(false);
+
+    load_mask_ = verticalMask(centreChunk.y, VERTICAL_LOAD_RADIUS);
+    keep_mask_ = verticalMask(centreChunk.y, VERTICAL_LOAD_RADIUS + 1);
+    if (moved_vertically) {
+        // best score last, streamVertically takes them off the back; from the offsets rather than the columns,
+        // which would all be read just for their coords
+        std::vector<std::pair<float, glm::ivec2> > scored;
+        scored.reserve(LOAD_RADIUS_OFFSETS.size());
+        for (auto &offset: LOAD_RADIUS_OFFSETS) scored.emplace_back(priority_(centre + offset), centre + offset);
+        std::ranges::sort(scored, std::ranges::greater{}, &std::pair<float, glm::ivec2>::first);
+        vertical_columns_.clear();
+        for (auto &[_, column_coord]: scored) vertical_columns_.push_back(column_coord);
+    }
+    streamVertically();
+
+    for (auto &offset: LOAD_RADIUS_OFFSETS) {
+        glm::ivec2 column_coord = centre + offset;
+        if (!chunk_columns_.contains(column_coord) && !loading_columns_.contains(column_coord))
+            loadColumn(column_coord);
+    }
+
+    prefetchAround(centre, velocity);
+}
+
+std::vector<ChunkColumn *> World::integrateColumns() {
+    auto start = std::chrono::steady_clock::now();
+
+    // a finished job has handed its result over already, get() only rethrows what a failed one threw
+    std::erase_if(loads_in_flight_, [](core::JobHandle<void> &job) {
+        if (!job.ready()) return false;
+        job.get();
+        return true;
+    });
+    for (auto it = encoding_columns_.begin(); it != encoding_columns_.end();) {
+        if (!it->second.ready()) {
+            ++it;
+            continue;
+        }
+        it->second.get();
+        it = encoding_columns_.erase(it);
+    }
+
+    std::vector<ChunkColumn *> changed;
+    auto budget_us = static_cast<std::uint64_t>(integration_budget_.count());
+    do {
+        ColumnLoad load;
+        {
+            std::lock_guard lock(finished_mutex_);
+            if (finished_loads_.empty()) break;
+            load = std::move(finished_loads_.front());
+            finished_loads_.pop_front();
+        }
+
+        // cancelled after it finished, its map entry is gone already
+        if (load.cancel.cancelled()) {
+            pool_.release(std::move(load.column));
+            continue;
+        }
+
+        glm::ivec2 column_coord = load.column->coord();
+        if (load.vertical) {
+            auto it = loading_chunks_.find(column_coord);
+            if (it != loading_chunks_.end()) {
+                std::erase_if(it->second, [&](const ChunkLoad &chunkLoad) { return chunkLoad.cancel == load.cancel; });
+                if (it->second.empty()) loading_chunks_.erase(it);
+            }
+            spliceChunks(*load.column, load.chunks, changed);
+            pool_.release(std::move(load.column));
+        } else {
+            loading_columns_.erase(column_coord);
+            integrateColumn(std::move(load.column), changed);
+        }
+    } while (elapsedMicroseconds(start) < budget_us);
+    unqueueCancelledLoads();
+    return changed;
+}
+
+void World::prioritise(const StreamPriority &priority) {
+    priority_ = priority;
+    auto score = [&](const QueuedLoad &load) { return priority_(load.coord); };
+    column_queue_.rescore(score);
+    chunk_queue_.rescore(score);
+}
+
+bool World::streaming() const {
+    return !loads_in_flight_.empty() || !loading_columns_.empty() || !loading_chunks_.empty() ||
+           !vertical_columns_.empty();
+}
+
+StreamStats World::takeStreamStats() {
+    return {
+        std::exchange(columns_integrated_, 0), stream_stats_.cold_hits.exchange(0),
+        stream_stats_.prefetch_hits.exchange(0), stream_stats_.io_wait_us.exchange(0)
+    };
+}
+
+void World::recordEdit(const glm::ivec3 &worldCoord, BlockId blockId) {
+    glm::ivec3 local_coord(worldCoord.x & CHUNK_MASK, worldCoord.y, worldCoord.z & CHUNK_MASK);
+    glm::ivec2 column_coord = worldToColumn(worldCoord);
+    region_store_->appendEdit(column_coord, {local_coord, blockId});
+    prefetcher_->invalidate(column_coord);
+    dirty_chunks_[column_coord] |= ChunkMask{1} << (worldCoord.y >> CHUNK_BITS);
+    persistence_stats_.edits_journaled += 1;
+}
+
+std::vector<SaveCycle> World::autosave() {
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_autosave_ >= autosave_interval_ && saver_->idle()) {
+        last_autosave_ = now;
+
+        std::vector<glm::ivec2> dirty_columns;
+        dirty_columns.reserve(dirty_chunks_.size());
+        for (const glm::ivec2 &column_coord: dirty_chunks_ | std::views::keys) dirty_columns.push_back(column_coord);
+
+        std::vector<SaveJob> jobs;
+        for (const glm::ivec2 &column_coord: dirty_columns) {
+            // unloaded since: its edits stay journaled until it is saved while loaded again
+            if (const ChunkColumn *column = chunk_columns_.find(column_coord)) captureSave(*column, jobs);
+            else dirty_chunks_.erase(column_coord);
+        }
+        saver_->submit(std::move(jobs), elapsedMicroseconds(now));
+    }
+    return saver_->takeFinished();
+}
+
+void World::compactJournals() {
+    std::vector<SaveJob> jobs;
+    for (const ChunkColumn &column: chunk_columns_.values()) captureSave(column, jobs);
+    saver_->submit(std::move(jobs));
+}
+
+void World::captureSave(const ChunkColumn &column, std::vector<SaveJob> &jobs) {
+    ChunkMask mask = 0;
+    if (auto it = dirty_chunks_.find(column.coord()); it != dirty_chunks_.end()) {
+        mask = it->second;
+        dirty_chunks_.erase(it);
+    }
+    if (region_store_->editCount(column.coord(), column.loadedMask()) >= SNAPSHOT_EDITS) mask = ALL_CHUNKS;
+
+    mask &= column.loadedMask();
+    if (mask) jobs.push_back(ColumnSaver::capture(column, mask, *region_store_));
+}
+
+void World::openStore() {
+    std::string mode = terrainModeName(generator_.mode());
+    // the prefetcher and saver use the store, so they go first (the saver finishing its queue) and come back last
+    prefetcher_.reset();
+    saver_.reset();
+    region_store_ = std::make_unique<RegionStore>(
+        std::filesystem::path(SAVE_DIRECTORY) / (mode + "_" + std::to_string(generator_.seed())));
+    prefetcher_ = std::make_unique<ColumnPrefetcher>(*region_store_);
+    saver_ = std::make_unique<ColumnSaver>(*region_store_, save_bytes_per_second_);
+}
+
+void World::prefetchAround(const glm::ivec2 &centre, const glm::vec2 &velocity) {
+    prefetcher_->retain(centre, PREFETCH_RADIUS);
+
+    float speed = glm::length(velocity);
+    glm::vec2 heading = speed > 0.f ? velocity / speed : glm::vec2(0.f);
+
+    // most aligned with the heading first, so a full read queue drops the columns needed last
+    std::vector<std::pair<float, glm::ivec2> > candidates;
+    for (auto &offset: PREFETCH_RADIUS_OFFSETS) {
+        int distance_squared = offset.x * offset.x + offset.y * offset.y;
+        if (distance_squared <= LOAD_RADIUS * LOAD_RADIUS) continue;
+        if (cold_columns_.contains(centre + offset)) continue;
+
+        float alignment = glm::dot(glm::vec2(offset), heading) / std::sqrt(static_cast<float>(distance_squared));
+        if (speed > 0.f && alignment < PREFETCH_MIN_ALIGNMENT) continue;
+        candidates.emplace_back(-alignment, centre + offset);
+    }
+    std::ranges::sort(candidates, {}, &std::pair<float, glm::ivec2>::first);
+
+    for (auto &[_, column_coord]: candidates)
+        if (!prefetcher_->request(column_coord)) break;
+}
+
+void World::streamVertically() {
+    if (vertical_columns_.empty()) return;
+
+    auto start = std::chrono::steady_clock::now();
+    auto budget_us = static_cast<std::uint64_t>(vertical_budget_.count());
+    do {
+        glm::ivec2 column_coord = vertical_columns_.back();
+        vertical_columns_.pop_back();
+        // released since the window moved
+        ChunkColumn *column = chunk_columns_.find(column_coord);
+        if (!column) continue;
+
+        column->unloadChunks(column->loadedMask() & ~keep_mask_, pool_);
+        loadChunksDetached(*column, load_mask_ & ~column->loadedMask());
+    } while (!vertical_columns_.empty() && elapsedMicroseconds(start) < budget_us);
+    unqueueCancelledLoads();
+}
+
+void World::loadColumn(const glm::ivec2 &columnCoord) {
+    core::JobHandle<void> encoding;
+    if (auto it = encoding_columns_.find(columnCoord); it != encoding_columns_.end()) encoding = it->second;
+
+    core::CancelToken cancel;
+    loading_columns_.emplace(columnCoord, cancel);
+    queueLoad({columnCoord, load_mask_, false, std::move(cancel), std::move(encoding)});
+}
+
+void World::loadChunksDetached(const ChunkColumn &column, ChunkMask mask) {
+    auto it = loading_chunks_.find(column.coord());
+    if (it != loading_chunks_.end()) {
+        // superseded by the window moving on; one that still has wanted chunks runs, spliceChunks drops the rest
+        std::erase_if(it->second, [&](const ChunkLoad &chunkLoad) {
+            if (chunkLoad.chunks & keep_mask_) return false;
+            chunkLoad.cancel.cancel();
+            return true;
+        });
+        for (const ChunkLoad &chunkLoad: it->second) mask &= ~chunkLoad.chunks;
+    }
+    if (!mask) {
+        if (it != loading_chunks_.end() && it->second.empty()) loading_chunks_.erase(it);
+        return;
+    }
+
+    core::CancelToken cancel;
+    if (it == loading_chunks_.end()) it = loading_chunks_.try_emplace(column.coord()).first;
+    it->second.push_back({mask, cancel});
+    queueLoad({column.coord(), mask, true, std::move(cancel), {}});
+}
+
+void World::queueLoad(QueuedLoad load) {
+    float score = priority_(load.coord);
+    bool vertical = load.vertical;
+    (vertical ? chunk_queue_ : column_queue_).push(std::move(load), score);
+    // chunks of the columns already on screen fill in ahead of new columns
+    loads_in_flight_.emplace_back(jobs_.submit([this, vertical] { runQueuedLoad(vertical); },
+                                               vertical ? core::JobPriority::High : core::JobPriority::Normal));
+}
+
+void World::cancelLoads(bool all) {
+    // erase_if hands out const entries, cancel() only raises the shared flag
+    std::erase_if(loading_columns_, [&](const auto &entry) {
+        if (!all && inLoadRadius(entry.first)) return false;
+        entry.second.cancel();
+        return true;
+    });
+    std::erase_if(loading_chunks_, [&](const auto &entry) {
+        if (!all && inLoadRadius(entry.first)) return false;
+        for (const ChunkLoad &chunkLoad: entry.second) chunkLoad.cancel.cancel();
+        return true;
+    });
+    unqueueCancelledLoads();
+}
+
+void World::unqueueCancelledLoads() {
+    auto cancelled = [](const QueuedLoad &load) { return load.cancel.cancelled(); };
+    column_queue_.extractIf(cancelled, [&](QueuedLoad) { column_cancels_.cancelled(0, false); });
+    chunk_queue_.extractIf(cancelled, [&](QueuedLoad) { chunk_cancels_.cancelled(0, false); });
+}
+
+void World::runQueuedLoad(bool vertical) {
+    // one job per queued load, though not necessarily the one it was queued with; a dropped load leaves a job
+    // with nothing to do
+    std::optional<QueuedLoad> load = (vertical ? chunk_queue_ : column_queue_).pop();
+    if (!load) return;
+
+    core::CancelLedger &ledger = load->vertical ? chunk_cancels_ : column_cancels_;
+    // cancelled since the last unqueueCancelledLoads
+    if (load->cancel.cancelled()) {
+        ledger.cancelled(0, false);
+        return;
+    }
+
+    // the cold tier gets the column's latest blocks once its last release is encoded; the wait runs other jobs,
+    // so the load is timed from after it
+    if (load->encoding.valid()) load->encoding.wait();
+    auto start = std::chrono::steady_clock::now();
+    auto column = pool_.acquireColumn(load->coord);
+    bool loaded = load->vertical ? loadChunks(*column, load->chunks, readColumn(load->coord), load->cancel)
+                                 : populateColumn(*column, load->chunks, load->cancel);
+
+    if (!loaded) {
+        pool_.release(std::move(column));
+        ledger.cancelled(elapsedMicroseconds(start), true);
+        return;
+    }
+    ledger.finished(elapsedMicroseconds(start));
+    finishLoad({std::move(column), load->chunks, load->vertical, std::move(load->cancel)});
+}
+
+void World::finishLoad(ColumnLoad load) {
+    std::lock_guard lock(finished_mutex_);
+    finished_loads_.emplace_back(std::move(load));
+}
+
+void World::integrateColumn(std::unique_ptr<ChunkColumn> column, std::vector<ChunkColumn *> &changed) {
+    // a column that left LOAD_RADIUS had its load cancelled, so this one is in range
+    ++columns_integrated_;
+    glm::ivec2 column_coord = column->coord();
+    ChunkColumn &loaded = *column;
+    // a column left in the slot is saved and recycled rather than dropped with its edits
+    if (std::unique_ptr<ChunkColumn> displaced = chunk_columns_.emplace(column_coord, std::move(column))) {
+        std::erase(changed, displaced.get());
+        std::vector<std::unique_ptr<ChunkColumn> > retired;
+        retired.emplace_back(std::move(displaced));
+        retireColumns(std::move(retired), false);
+    }
+
+    // loaded for the vertical window at the time it was queued
+    loaded.unloadChunks(loaded.loadedMask() & ~keep_mask_, pool_);
+    if (ChunkMask missing = load_mask_ & ~loaded.loadedMask()) loadChunksDetached(loaded, missing);
+
+    for (Direction direction: HORIZONTAL_DIRECTIONS) {
+        glm::ivec2 neighbor_column_coord = column_coord + horizontalDirectionToNormalOffset(direction);
+        if (ChunkColumn *neighbor = chunk_columns_.find(neighbor_column_coord))
+            loaded.linkNeighbor(direction, *neighbor);
+    }
+
+    // a column becomes meshable when the last of its neighbours arrives, which may be one loaded earlier
+    promoteReady(loaded);
+    changed.push_back(&loaded);
+    for (ChunkColumn *neighbor: loaded.neighbors())
+        if (neighbor) {
+            promoteReady(*neighbor);
+            changed.push_back(neighbor);
+        }
+}
+
+void World::spliceChunks(ChunkColumn &detached, ChunkMask mask, std::vector<ChunkColumn *> &changed) {
+    ChunkColumn *column = chunk_columns_.find(detached.coord());
+    if (!column) return;
+
+    // the window may have moved on since the load was queued
+    mask &= keep_mask_ & ~column->loadedMask();
+    if (!mask) return;
+
+    column->adoptChunks(detached, mask);
+    // border meshes on either side read the new chunks
+    changed.push_back(column);
+    for (ChunkColumn *neighbor: column->neighbors())
+        if (neighbor) changed.push_back(neighbor);
+}
+
+void World::drainStreaming() {
+    cancelLoads(true);
+    for (auto &job: loads_in_flight_) job.wait();
+    for (auto &encode: encoding_columns_ | std::views::values) encode.wait();
+    loads_in_flight_.clear();
+    encoding_columns_.clear();
+    loading_columns_.clear();
+    loading_chunks_.clear();
+    vertical_columns_.clear();
+
+    std::deque<ColumnLoad> finished;
+    {
+        std::lock_guard lock(finished_mutex_);
+        finished.swap(finished_loads_);
+    }
+    for (ColumnLoad &load: finished) pool_.release(std::move(load.column));
+}
+
+bool World::populateColumn(ChunkColumn &column, ChunkMask chunkMask, const core::CancelToken &cancel) {
+    // a cold column already holds its edits, only chunks it did not have loaded are read and replayed
+    if (std::optional<std::vector<std::uint8_t> > payload = cold_columns_.take(column.coord())) {
+        if (ColumnCodec::decode(*payload, column, pool_, chunkMask)) {
+            stream_stats_.cold_hits += 1;
+            chunkMask &= ~column.loadedMask();
+            if (!chunkMask) {
+                prefetcher_->invalidate(column.coord());
+                column.advanceStage(GenerationStage::Decorated);
+                return true;
+            }
+        }
+    }
+
+    std::optional<StoredColumn> stored = prefetcher_->take(column.coord());
+    if (stored) stream_stats_.prefetch_hits += 1;
+    else stored = readColumn(column.coord());
+
+    return loadChunks(column, chunkMask, *stored, cancel);
+}
+
+bool World::loadChunks(ChunkColumn &column, ChunkMask chunkMask, const StoredColumn &stored,
+                       const core::CancelToken &cancel) {
+    chunkMask &= ~column.loadedMask();
+    if (!chunkMask) return true;
+
+    if (cancel.cancelled()) return false;
+    if (stored.snapshot) loadSnapshot(*stored.snapshot, column, chunkMask);
+    ChunkMask generated = chunkMask & ~column.loadedMask();
+    if (generated && !generateColumn(column, generated, cancel)) return false;
+    column.advanceStage(GenerationStage::Terrain);
+
+    if (cancel.cancelled()) return false;
+    // saved chunks were decorated before they were saved
+    if (generated) decorateColumn(column, generated);
+    replayEdits(stored.edits, column, chunkMask);
+    column.advanceStage(GenerationStage::Decorated);
+    return true;
+}
+
+StoredColumn World::readColumn(const glm::ivec2 &columnCoord) {
+    auto start = std::chrono::steady_clock::now();
+    StoredColumn stored = region_store_->readColumn(columnCoord);
+    stream_stats_.io_wait_us += elapsedMicroseconds(start);
+    return stored;
+}
+
+void World::loadSnapshot(const std::vector<std::uint8_t> &payload, ChunkColumn &column, ChunkMask chunkMask) {
+    auto start = std::chrono::steady_clock::now();
+
+    ChunkMask loaded = column.loadedMask();
+    if (!ColumnCodec::decode(payload, column, pool_, chunkMask) || column.loadedMask() == loaded) return;
+
+    persistence_stats_.chunks_loaded += std::popcount(column.loadedMask() & ~loaded);
+    persistence_stats_.load_us += elapsedMicroseconds(start);
+}
+
+bool World::generateColumn(ChunkColumn &column, ChunkMask chunkMask, const core::CancelToken &cancel) {
+    auto start = std::chrono::steady_clock::now();
+    // chunk by chunk, the heightmap is built once on the first
+    for (ChunkMask remaining = chunkMask; remaining; remaining &= remaining - 1) {
+        if (cancel.cancelled()) {
+            persistence_stats_.generate_us += elapsedMicroseconds(start);
+            return false;
+        }
+        generator_.generate(column, pool_, ChunkMask{1} << std::countr_zero(remaining));
+    }
+    persistence_stats_.chunks_generated += std::popcount(chunkMask);
+    persistence_stats_.generate_us += elapsedMicroseconds(start);
+    return true;
+}
+
+void World::decorateColumn(ChunkColumn &column, ChunkMask chunkMask) {
+    auto start = std::chrono::steady_clock::now();
+    generator_.decorate(column, pool_, chunkMask);
+    persistence_stats_.generate_us += elapsedMicroseconds(start);
+}
+
+void World::promoteReady(ChunkColumn &column) {
+    if (column.stage() != GenerationStage::Decorated) return;
+    for (const ChunkColumn *neighbor: column.neighbors())
+        if (!neighbor || neighbor->stage() < GenerationStage::Decorated) return;
+    column.advanceStage(GenerationStage::Ready);
+}
+
+void World::replayEdits(const std::vector<BlockEdit> &edits, ChunkColumn &column, ChunkMask chunkMask) {
+    std::uint64_t replayed = 0;
+    for (const BlockEdit &edit: edits) {
+        int index = edit.local_coord.y >> CHUNK_BITS;
+        if (!((chunkMask >> index) & 1u)) continue;
+        glm::ivec3 local_coord = edit.local_coord & CHUNK_MASK;
+        ++replayed;
+
+        auto &chunk = column.chunks()[index];
+        if (!chunk) {
+            if (edit.id == BlockId::Air) continue;
+            chunk = pool_.acquireChunk({column.coord().x, index, column.coord().y});
+        }
+        chunk->setBlock(local_coord, edit.id);
+        if (chunk->isEmpty()) pool_.release(std::move(chunk));
+    }
+
+    persistence_stats_.edits_replayed += replayed;
+}
+
+void World::retireColumns(std::vector<std::unique_ptr<ChunkColumn> > columns, bool keepCold) {
+    std::vector<SaveJob> jobs;
+    for (const auto &column: columns) captureSave(*column, jobs);
+    saver_->submit(std::move(jobs));
+
+    for (auto &column: columns) {
+        if (!keepCold) {
+            pool_.release(std::move(column));
+            continue;
+        }
+        glm::ivec2 column_coord = column->coord();
+        column->unlinkNeighbors();
+        encoding_columns_[column_coord] = jobs_.submit([this, column = std::move(column)]() mutable {
+            cold_columns_.insert(column->coord(), ColumnCodec::encode(*column));
+            pool_.release(std::move(column));
+        }, core::JobPriority::Low);
+    }
+}
@@ -1,21 +1,27 @@
 #pragma once
-#include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <glm/glm.hpp>
-#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "Chunk.h"
 #include "ChunkColumn.h"
-#include "PerlinNoise.h"
+#include "ChunkColumnPool.h"
+#include "ColdColumnCache.h"
+#include "ColumnPrefetcher.h"
+#include "ColumnRing.h"
+#include "ColumnSaver.h"
+#include "RegionStore.h"
+#include "StreamPriority.h"
+#include "TerrainGenerator.h"
+#include "core/JobSystem.h"
+#include "core/WorkQueue.h"
 
 namespace mc::world {
-    struct ColumnHash {
-        std::size_t operator()(const glm::ivec2 &columnCoord) const noexcept {
-            std::uint64_t h = static_cast<std::uint64_t>(columnCoord.x) * 73856093ull;
-            h ^= static_cast<std::uint64_t>(columnCoord.y) * 83492791ull;
-            return h;
-        }
-    };
-
     struct ChunkLookup {
         ChunkColumn *chunk_column;
         Chunk *chunk;
@@ -23,38 +29,87 @@ namespace mc::world {
         glm::ivec3 local_coord;
     };
 
-    enum class TerrainGenerationMode {
-        SineWave,
-        PerlinNoise
+    struct PersistenceStats {
+        // counted in chunks: vertical streaming loads and generates a column a few chunks at a time
+        std::uint64_t chunks_loaded = 0, chunks_generated = 0;
+        std::uint64_t edits_journaled = 0, edits_replayed = 0;
+        std::uint64_t load_us = 0, generate_us = 0; // summed over worker threads
+    };
+
+    // disk traffic of the columns integrated since the stats were last taken
+    struct StreamStats {
+        std::uint64_t columns = 0, cold_hits = 0, prefetch_hits = 0;
+        std::uint64_t io_wait_us = 0; // synchronous reads of columns the prefetcher did not have, summed over workers
     };
 
     class World {
     public:
-        explicit World(TerrainGenerationMode terrainGenerationMode = TerrainGenerationMode::SineWave,
+        static constexpr const char *SAVE_DIRECTORY = "saves";
+        // readahead only covers the ring ahead of the camera, within this cosine of its heading
+        static constexpr float PREFETCH_MIN_ALIGNMENT = -0.25f;
+        // journaled edits after which a column is cheaper to store as a region file snapshot (~8 bytes per edit)
+        static constexpr std::size_t SNAPSHOT_EDITS = 2048;
+        static constexpr std::chrono::milliseconds DEFAULT_AUTOSAVE_INTERVAL{30'000};
+        // time integrateColumns may spend per call; at least one finished load goes in regardless
+        static constexpr std::chrono::microseconds DEFAULT_INTEGRATION_BUDGET{2'000};
+        // time streamChunkColumns may spend per call queueing the chunks a vertical move brought into the window;
+        // at least one column is queued regardless, the rest wait for the next call
+        static constexpr std::chrono::microseconds DEFAULT_VERTICAL_BUDGET{1'000};
+
+        // generation, loading and cold tier encoding run as jobs on the given system
+        explicit World(core::JobSystem &jobs,
+                       TerrainGenerationMode terrainGenerationMode = TerrainGenerationMode::SineWave,
                        std::uint32_t seed = 0)
-            : terrain_generation_mode_{terrainGenerationMode}, seed_{seed}, perlin_noise_{seed} {
-            chunk_columns_.reserve(LOAD_AREA_SIZE);
+            : jobs_{jobs}, generator_{terrainGenerationMode, seed} {
             last_stream_centre_ = glm::ivec2(std::numeric_limits<int>::min());
+            last_stream_centre_y_ = std::numeric_limits<int>::min();
+            openStore();
+        }
+
+        // the saver goes before the store and writes out what compactJournals queued
+        ~World() {
+            drainStreaming();
+            compactJournals();
         }
 
+        World(const World &) = delete;
+
+        World &operator=(const World &) = delete;
+
         const auto &chunk_columns() const { return chunk_columns_; }
 
+        ChunkColumn *findColumn(const glm::ivec2 &columnCoord) const { return chunk_columns_.find(columnCoord); }
+
         void setSeed(std::uint32_t seed) {
-            seed_ = seed;
-            perlin_noise_ = PerlinNoise(seed);
-            chunk_columns_.clear();
+            drainStreaming();
+            compactJournals();
+            generator_ = TerrainGenerator(generator_.mode(), seed);
+            releaseColumns([](const glm::ivec2 &) { return true; }, false);
+            cold_columns_.clear();
+            dirty_chunks_.clear();
             last_stream_centre_ = glm::ivec2(std::numeric_limits<int>::min());
+            last_stream_centre_y_ = std::numeric_limits<int>::min();
+            openStore();
         }
 
         void toggleTerrainMode() {
-            terrain_generation_mode_ = terrain_generation_mode_ == TerrainGenerationMode::SineWave
-                                           ? TerrainGenerationMode::PerlinNoise
-                                           : TerrainGenerationMode::SineWave;
-            chunk_columns_.clear();
+            drainStreaming();
+            compactJournals();
+            generator_ = TerrainGenerator(static_cast<TerrainGenerationMode>(
+                                              (static_cast<int>(generator_.mode()) + 1) % TERRAIN_MODES_COUNT),
+                                          generator_.seed());
+            // generation stats are per mode, so they compare
+            persistence_stats_.chunks_generated = 0;
+            persistence_stats_.generate_us = 0;
+            releaseColumns([](const glm::ivec2 &) { return true; }, false);
+            cold_columns_.clear();
+            dirty_chunks_.clear();
             last_stream_centre_ = glm::ivec2(std::numeric_limits<int>::min());
+            last_stream_centre_y_ = std::numeric_limits<int>::min();
+            openStore();
         }
 
-        glm::ivec2 worldToColumn(const glm::ivec3 &worldCoord) {
+        static glm::ivec2 worldToColumn(const glm::ivec3 &worldCoord) {
             return {
                 worldCoord.x >> CHUNK_BITS,
                 worldCoord.z >> CHUNK_BITS
@@ -64,13 +119,13 @@ namespace mc::world {
         ChunkLookup chunkLookup(const glm::ivec3 &worldCoord) {
             glm::ivec2 column_coord = worldToColumn(worldCoord);
 
-            if (auto it = chunk_columns_.find(column_coord); it != chunk_columns_.end()) {
+            if (ChunkColumn *column = chunk_columns_.find(column_coord)) {
                 int index = worldToChunk(worldCoord).y;
                 if (index < 0 || index >= CHUNKS_PER_COLUMN)
-                    return {it->second.get(), nullptr, -1, {}};
+                    return {column, nullptr, -1, {}};
 
                 glm::ivec3 local_coord = worldCoord & CHUNK_MASK;
-                return {it->second.get(), it->second->chunks()[index].get(), index, local_coord};
+                return {column, column->chunks()[index].get(), index, local_coord};
             }
             return {nullptr, nullptr, -1, {}};
         }
@@ -79,92 +134,241 @@ namespace mc::world {
             return const_cast<World *>(this)->chunkLookup(worldCoord);
         }
 
-        std::vector<ChunkColumn *> streamChunkColumns(const glm::ivec2 &centre) {
-            if (centre == last_stream_centre_) return {};
-            last_stream_centre_ = centre;
+        // unloads what left LOAD_RADIUS of the centre chunk (VERTICAL_LOAD_RADIUS + 1 vertically) and queues loads
+        // for the columns and chunks entering it without waiting on them, integrateColumns takes them in;
+        // velocity in blocks per second (xz), biases the readahead of columns beyond LOAD_RADIUS. meant to be called
+        // every frame: after a vertical move the loaded columns get their chunk loads queued over several calls,
+        // best scored first, within the vertical budget
+        void streamChunkColumns(const glm::ivec3 &centreChunk, const glm::vec2 &velocity = {});
 
-            std::erase_if(chunk_columns_, [&](const auto &kv) {
-                glm::ivec2 d = kv.first - centre;
-                return d.x * d.x + d.y * d.y > LOAD_RADIUS * LOAD_RADIUS;
-            });
+        // re-scores the queued loads, and scores the ones queued from here on; workers take the best one left
+        void prioritise(const StreamPriority &priority);
 
-            std::vector<std::future<std::unique_ptr<ChunkColumn> > > futures;
+        // links finished columns into the world and splices finished vertical loads into their columns until the
+        // integration budget is spent; returns the columns whose chunks or stage changed, neighbours included
+        std::vector<ChunkColumn *> integrateColumns();
 
-            for (auto &offset: LOAD_RADIUS_OFFSETS) {
-                glm::ivec2 column_coord = centre + offset;
-                if (chunk_columns_.contains(column_coord)) continue;
+        // loads waiting to be queued, queued, running or finished but not integrated yet
+        bool streaming() const;
 
-                futures.emplace_back(std::async(
-                    std::launch::async, [this, column_coord]() -> std::unique_ptr<ChunkColumn> {
-                        auto column = std::make_unique<ChunkColumn>(column_coord);
+        void setIntegrationBudget(std::chrono::microseconds budget) { integration_budget_ = budget; }
 
-                        if (terrain_generation_mode_ == TerrainGenerationMode::SineWave)
-                            column->generateTerrain([this](int wx, int wz) { return sineHeight(wx, wz, seed_); });
-                        else column->generateTerrain([this](int wx, int wz) { return perlinHeight(wx, wz); });
+        void setVerticalBudget(std::chrono::microseconds budget) { vertical_budget_ = budget; }
 
-                        return std::move(column);
-                    }));
-            }
+        // appends a block change made by the player to its region's edit journal and marks its chunk dirty
+        void recordEdit(const glm::ivec3 &worldCoord, BlockId blockId);
 
-            std::vector<ChunkColumn *> created_columns;
-            created_columns.reserve(futures.size());
+        // once per autosave interval, hands copies of the dirty chunks to the background saver, which folds them
+        // into the region files and drops the edits they cover from the journals; skipped while the previous
+        // cycle is still being written. returns the cycles written since the last call
+        std::vector<SaveCycle> autosave();
 
-            for (auto &f: futures) {
-                auto column_ptr = f.get();
-                ChunkColumn *column = column_ptr.get();
-                chunk_columns_.emplace(column->coord(), std::move(column_ptr));
-                created_columns.emplace_back(column);
-            }
+        // queues a save of every loaded column with dirty chunks or a journal past SNAPSHOT_EDITS
+        void compactJournals();
 
-            for (ChunkColumn *column: created_columns)
-                for (Direction direction: HORIZONTAL_DIRECTIONS) {
-                    glm::ivec2 neighbor_column_coord = column->coord() + horizontalDirectionToNormalOffset(direction);
-                    if (auto it = chunk_columns_.find(neighbor_column_coord); it != chunk_columns_.end())
-                        column->linkNeighbor(direction, *it->second);
-                }
+        void setAutosaveInterval(std::chrono::milliseconds interval) { autosave_interval_ = interval; }
 
-            return created_columns;
+        void setSaveBandwidth(std::size_t bytesPerSecond) {
+            save_bytes_per_second_ = bytesPerSecond;
+            saver_->setBandwidth(bytesPerSecond);
         }
 
-        TerrainGenerationMode terrain_generation_mode() const { return terrain_generation_mode_; }
-        int seed() const { return seed_; }
+        std::size_t memoryUsage() const {
+            std::size_t bytes = 0;
+            for (const ChunkColumn &column: chunk_columns_.values())
+                bytes += column.memoryUsage();
+            return bytes;
+        }
 
-    private:
-        std::unordered_map<glm::ivec2, std::unique_ptr<ChunkColumn>, ColumnHash> chunk_columns_;
+        ChunkPoolStats poolStats() const { return pool_.stats(); }
 
-        TerrainGenerationMode terrain_generation_mode_;
-        std::uint32_t seed_ = 0;
-        PerlinNoise perlin_noise_;
-        glm::ivec2 last_stream_centre_;
+        ChunkColumnPool &pool() { return pool_; }
 
-        glm::ivec3 worldToChunk(const glm::ivec3 &worldCoord) {
+        PersistenceStats persistenceStats() const {
             return {
-                worldCoord.x >> CHUNK_BITS,
-                worldCoord.y >> CHUNK_BITS,
-                worldCoord.z >> CHUNK_BITS
+                persistence_stats_.chunks_loaded.load(), persistence_stats_.chunks_generated.load(),
+                persistence_stats_.edits_journaled.load(), persistence_stats_.edits_replayed.load(),
+                persistence_stats_.load_us.load(), persistence_stats_.generate_us.load()
             };
         }
 
-        int sineHeight(int wx, int wz,
-                       int seed,
-                       int base = 64,
-                       int amplitude = 48) {
-            constexpr float INV_64_TAU = 1.f / 64.f * 6.283185f;
+        PrefetchStats prefetchStats() const { return prefetcher_->stats(); }
+
+        SaveStats saveStats() const { return saver_->stats(); }
+
+        ColdCacheStats coldCacheStats() const { return cold_columns_.stats(); }
+
+        void setColdCacheBudget(std::size_t budgetBytes) { cold_columns_.setBudget(budgetBytes); }
+
+        StreamStats takeStreamStats();
+
+        // loads given up because their column left LOAD_RADIUS, their chunks the vertical window, or the world was
+        // reseeded or switched modes
+        core::CancelStats cancelStats() const {
+            core::CancelStats stats = column_cancels_.stats();
+            stats += chunk_cancels_.stats();
+            return stats;
+        }
+
+        TerrainGenerationMode terrain_generation_mode() const { return generator_.mode(); }
+        int seed() const { return static_cast<int>(generator_.seed()); }
+
+    private:
+        core::JobSystem &jobs_;
+        ChunkColumnPool pool_;
+        ColumnRing<ChunkColumn, LOAD_RADIUS> chunk_columns_;
+        ColdColumnCache cold_columns_;
+        std::unique_ptr<RegionStore> region_store_;
+        std::unique_ptr<ColumnPrefetcher> prefetcher_;
+        std::unique_ptr<ColumnSaver> saver_;
+
+        // chunks edited since their column was last handed to the saver
+        std::unordered_map<glm::ivec2, ChunkMask, ColumnHash> dirty_chunks_;
+        std::chrono::milliseconds autosave_interval_ = DEFAULT_AUTOSAVE_INTERVAL;
+        std::chrono::steady_clock::time_point last_autosave_ = std::chrono::steady_clock::now();
+        std::size_t save_bytes_per_second_ = ColumnSaver::DEFAULT_BYTES_PER_SECOND;
+
+        struct {
+            std::atomic<std::uint64_t> chunks_loaded{0}, chunks_generated{0};
+            std::atomic<std::uint64_t> edits_journaled{0}, edits_replayed{0};
+            std::atomic<std::uint64_t> load_us{0}, generate_us{0};
+        } persistence_stats_;
+
+        struct {
+            std::atomic<std::uint64_t> cold_hits{0}, prefetch_hits{0}, io_wait_us{0};
+        } stream_stats_;
+        std::uint64_t columns_integrated_ = 0;
+
+        // a populated column, or for a vertical load a detached column holding the chunks to splice into the
+        // loaded one at its coord
+        struct ColumnLoad {
+            std::unique_ptr<ChunkColumn> column;
+            ChunkMask chunks;
+            bool vertical;
+            core::CancelToken cancel; // raised after it finished, it is dropped all the same
+        };
+
+        // a column, or with vertical chunks of a loaded one, waiting for a worker
+        struct QueuedLoad {
+            glm::ivec2 coord;
+            ChunkMask chunks;
+            bool vertical;
+            core::CancelToken cancel;
+            core::JobHandle<void> encoding; // the cold tier encode of the column's last release, when still running
+        };
+
+        struct ChunkLoad {
+            ChunkMask chunks;
+            core::CancelToken cancel;
+        };
+
+        // vertical loads apart, their jobs run at High priority
+        core::WorkQueue<QueuedLoad> column_queue_, chunk_queue_;
+        StreamPriority priority_;
+
+        // workers append, integrateColumns takes from the front
+        std::mutex finished_mutex_;
+        std::deque<ColumnLoad> finished_loads_;
+        std::vector<core::JobHandle<void> > loads_in_flight_; // one per queued load, each running the best one
+        // queued or running, until integrateColumns takes them in or they are cancelled
+        std::unordered_map<glm::ivec2, core::CancelToken, ColumnHash> loading_columns_;
+        std::unordered_map<glm::ivec2, std::vector<ChunkLoad>, ColumnHash> loading_chunks_;
+        core::CancelLedger column_cancels_, chunk_cancels_;
+        // cold tier encodes of retired columns; a load of the same column waits for its encode
+        std::unordered_map<glm::ivec2, core::JobHandle<void>, ColumnHash> encoding_columns_;
+        std::chrono::microseconds integration_budget_ = DEFAULT_INTEGRATION_BUDGET;
+        // loaded columns whose chunks have yet to follow the last vertical move, the next one at the back
+        std::vector<glm::ivec2> vertical_columns_;
+        std::chrono::microseconds vertical_budget_ = DEFAULT_VERTICAL_BUDGET;
+
+        TerrainGenerator generator_;
+        glm::ivec2 last_stream_centre_;
+        int last_stream_centre_y_;
+        ChunkMask load_mask_ = 0, keep_mask_ = 0;
+
+        // keepCold moves the released columns into the cold tier, for columns that may stream back in
+        template<typename Predicate>
+        void releaseColumns(Predicate shouldRelease, bool keepCold) {
+            std::vector<std::unique_ptr<ChunkColumn> > evicted;
+            chunk_columns_.extractIf(shouldRelease, [&](const glm::ivec2 &, std::unique_ptr<ChunkColumn> column) {
+                evicted.emplace_back(std::move(column));
+            });
+            retireColumns(std::move(evicted), keepCold);
+        }
+
+        // waits out every queued load and encode and drops their results, before the generator or store change
+        void drainStreaming();
 
-            float sx = std::sinf((wx + seed) * INV_64_TAU);
-            float cz = std::cosf((wz + seed) * INV_64_TAU);
-            float h = base + amplitude * (sx + cz) / 2.f;
-            return std::clamp(static_cast<int>(h), MIN_WORLD_Y, MAX_WORLD_Y);
+        void openStore();
+
+        void prefetchAround(const glm::ivec2 &centre, const glm::vec2 &velocity);
+
+        // takes columns off vertical_columns_ until the vertical budget is spent, unloading their chunks outside
+        // keep_mask_ and queueing loads for those entering load_mask_
+        void streamVertically();
+
+        bool inLoadRadius(const glm::ivec2 &columnCoord) const {
+            glm::ivec2 d = columnCoord - last_stream_centre_;
+            return d.x * d.x + d.y * d.y <= LOAD_RADIUS * LOAD_RADIUS;
         }
 
-        int perlinHeight(int wx, int wz,
-                         int base = 80,
-                         int amplitude = 80,
-                         float scale = 32.f) const {
-            float h_f = perlin_noise_.noise(static_cast<float>(wx) / scale,
-                                            static_cast<float>(wz) / scale);
-            int h = base + static_cast<int>(h_f * amplitude);
-            return std::clamp(h, MIN_WORLD_Y, MAX_WORLD_Y);
+        void loadColumn(const glm::ivec2 &columnCoord);
+
+        // loads the chunks of mask into a detached column on a worker, for integrateColumns to splice into column;
+        // cancels the column's loads whose chunks all left the vertical window and skips chunks already loading
+        void loadChunksDetached(const ChunkColumn &column, ChunkMask mask);
+
+        void queueLoad(QueuedLoad load);
+
+        // cancels the loads of columns that left LOAD_RADIUS, or all of them, and drops those still queued
+        void cancelLoads(bool all);
+
+        // drops the queued loads cancelled since the last call
+        void unqueueCancelledLoads();
+
+        // on a worker: the queued column load, or vertical load, with the best score
+        void runQueuedLoad(bool vertical);
+
+        void finishLoad(ColumnLoad load);
+
+        void integrateColumn(std::unique_ptr<ChunkColumn> column, std::vector<ChunkColumn *> &changed);
+
+        void spliceChunks(ChunkColumn &detached, ChunkMask mask, std::vector<ChunkColumn *> &changed);
+
+        // false when cancel was raised partway, the column then holds part of the chunks
+        bool populateColumn(ChunkColumn &column, ChunkMask chunkMask, const core::CancelToken &cancel);
+
+        // region file snapshot for the chunks it holds (autosaves only write dirty ones), generated and decorated
+        // terrain for the rest, then the journaled edits on top; checks cancel between stages and generated chunks
+        bool loadChunks(ChunkColumn &column, ChunkMask chunkMask, const StoredColumn &stored,
+                        const core::CancelToken &cancel);
+
+        StoredColumn readColumn(const glm::ivec2 &columnCoord);
+
+        void loadSnapshot(const std::vector<std::uint8_t> &payload, ChunkColumn &column, ChunkMask chunkMask);
+
+        bool generateColumn(ChunkColumn &column, ChunkMask chunkMask, const core::CancelToken &cancel);
+
+        void decorateColumn(ChunkColumn &column, ChunkMask chunkMask);
+
+        // Ready once column and its horizontal neighbours are all Decorated
+        static void promoteReady(ChunkColumn &column);
+
+        void replayEdits(const std::vector<BlockEdit> &edits, ChunkColumn &column, ChunkMask chunkMask);
+
+        // pins the dirty chunks of column for the saver, or its whole loaded band once its journal holds
+        // SNAPSHOT_EDITS for it; clears the column's dirty mask
+        void captureSave(const ChunkColumn &column, std::vector<SaveJob> &jobs);
+
+        // queues saves of the columns' dirty chunks, then releases them, after a cold tier encode with keepCold
+        void retireColumns(std::vector<std::unique_ptr<ChunkColumn> > columns, bool keepCold);
+
+        static glm::ivec3 worldToChunk(const glm::ivec3 &worldCoord) {
+            return {
+                worldCoord.x >> CHUNK_BITS,
+                worldCoord.y >> CHUNK_BITS,
+                worldCoord.z >> CHUNK_BITS
+            };
         }
     };
 }
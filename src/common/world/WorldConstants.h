@@ -1,5 +1,7 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <glm/vec2.hpp>
 
 namespace mc::world {
@@ -7,13 +9,39 @@ namespace mc::world {
     constexpr int CHUNK_XYZ = 1 << CHUNK_BITS; // 32
     constexpr int CHUNK_MASK = CHUNK_XYZ - 1; // 31
 
-    constexpr int CHUNKS_PER_COLUMN = 8;
-    constexpr int WORLD_HEIGHT = CHUNK_XYZ * CHUNKS_PER_COLUMN; // 256
+    constexpr int CHUNKS_PER_COLUMN = 16;
+    constexpr int WORLD_HEIGHT = CHUNK_XYZ * CHUNKS_PER_COLUMN; // 512
     constexpr int MIN_WORLD_Y = 0;
     constexpr int MAX_WORLD_Y = WORLD_HEIGHT - 1;
 
+    // bit per chunk index of a column
+    using ChunkMask = std::uint32_t;
+    static_assert(CHUNKS_PER_COLUMN <= 32, "ChunkMask holds one bit per chunk of a column");
+    constexpr ChunkMask ALL_CHUNKS = CHUNKS_PER_COLUMN == 32 ? ~0u : (1u << CHUNKS_PER_COLUMN) - 1;
+
+    struct ColumnHash {
+        std::size_t operator()(const glm::ivec2 &columnCoord) const noexcept {
+            std::uint64_t h = static_cast<std::uint64_t>(columnCoord.x) * 73856093ull;
+            h ^= static_cast<std::uint64_t>(columnCoord.y) * 83492791ull;
+            return h;
+        }
+    };
+
     constexpr int RENDER_RADIUS = 32;
     constexpr int LOAD_RADIUS = RENDER_RADIUS + 1;
+    constexpr int PREFETCH_RADIUS = LOAD_RADIUS + 3; // disk reads run ahead of loading by this ring
+
+    // chunks are resident within VERTICAL_LOAD_RADIUS chunks of the camera's chunk and unloaded past
+    // one more, meshed within VERTICAL_RENDER_RADIUS so every meshed chunk has its vertical neighbours
+    constexpr int VERTICAL_RENDER_RADIUS = 3;
+    constexpr int VERTICAL_LOAD_RADIUS = VERTICAL_RENDER_RADIUS + 1;
+
+    constexpr ChunkMask verticalMask(int centreChunkY, int radius) {
+        ChunkMask mask = 0;
+        for (int i = std::max(centreChunkY - radius, 0); i <= std::min(centreChunkY + radius, CHUNKS_PER_COLUMN - 1); ++i)
+            mask |= 1u << i;
+        return mask;
+    }
 
     constexpr int numberOfElementsInEuclideanRadius(int radius) {
         int count = 0;
@@ -25,6 +53,7 @@ namespace mc::world {
 
     constexpr int RENDER_AREA_SIZE = numberOfElementsInEuclideanRadius(RENDER_RADIUS);
     constexpr int LOAD_AREA_SIZE = numberOfElementsInEuclideanRadius(LOAD_RADIUS);
+    constexpr int PREFETCH_AREA_SIZE = numberOfElementsInEuclideanRadius(PREFETCH_RADIUS);
 
     template<int RADIUS, int SIZE>
     constexpr std::array<glm::ivec2, SIZE> makeOffsets() {
@@ -39,4 +68,5 @@ namespace mc::world {
 
     constexpr auto RENDER_RADIUS_OFFSETS = makeOffsets<RENDER_RADIUS, RENDER_AREA_SIZE>();
     constexpr auto LOAD_RADIUS_OFFSETS = makeOffsets<LOAD_RADIUS, LOAD_AREA_SIZE>();
+    constexpr auto PREFETCH_RADIUS_OFFSETS = makeOffsets<PREFETCH_RADIUS, PREFETCH_AREA_SIZE>();
 }
@@ -1,7 +1,44 @@
+#include <algorithm>
+#include <map>
+#include <string_view>
+#include <thread>
+#include <vector>
 #include <asio.hpp>
 #include <spdlog/spdlog.h>
 
-int main() {
+#include "world/GenerationCheck.h"
+
+namespace {
+    // generates the golden columns at 1, 2 and all hardware threads; fails on a hash that differs from the
+    // golden one or between thread counts
+    int verifyGeneration() {
+        int hardware_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        std::vector<int> thread_counts = {1, 2};
+        if (hardware_threads > 2) thread_counts.push_back(hardware_threads);
+
+        bool passed = true;
+        std::map<std::pair<int, std::uint32_t>, std::uint64_t> first_hashes;
+        for (const mc::world::GenerationCheckResult &result: mc::world::GenerationCheck::run(thread_counts)) {
+            auto [first, inserted] = first_hashes.try_emplace({static_cast<int>(result.mode), result.seed},
+                                                              result.hash);
+            bool reproducible = inserted || first->second == result.hash;
+            passed = passed && result.matches() && reproducible;
+
+            spdlog::info("{:>7} seed {:>10}, {:>2} threads: {:016x} {}{}, {:.0f} columns/s",
+                         mc::world::terrainModeName(result.mode), result.seed, result.threads, result.hash,
+                         result.matches() ? "ok" : fmt::format("differs from golden {:016x}", result.golden),
+                         reproducible ? "" : ", differs between thread counts", result.columnsPerSecond());
+        }
+
+        if (passed) spdlog::info("World generation matches the golden hashes");
+        else spdlog::error("World generation changed");
+        return passed ? 0 : 1;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && std::string_view(argv[1]) == "--verify-generation") return verifyGeneration();
+
     asio::io_context context;
     spdlog::info("minecraft-clone headless server starting...");
     context.run();